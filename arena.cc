@@ -0,0 +1,148 @@
+#include <assert.h>
+#include <iostream>
+#include <memory_resource>
+#include <cstdint>
+#include <cstddef>
+#include "arena.h"
+#include "set.h"
+#include "ctest.h"
+
+bool is_aligned(const void *pointer, const size_t alignment) { return reinterpret_cast<uintptr_t>(pointer) % alignment == 0; }
+
+void test_monotonic_arena()
+{
+    arena::MonotonicArena arena{};
+    ctest::assert_equal(arena.allocated_bytes(), 0);
+
+    void *const first{arena.allocate(1, 1)};
+    void *const second{arena.allocate(8, 8)};
+    assert(is_aligned(second, 8));
+    // allocations follow each other in the same block
+    assert(static_cast<std::byte *>(second) - static_cast<std::byte *>(first) < 16);
+    assert(is_aligned(arena.allocate(64, 64), 64));
+    ctest::assert_equal(arena.allocated_bytes(), 73);
+
+    // bigger than a block, so it gets a block of its own
+    std::byte *const large{static_cast<std::byte *>(arena.allocate(4 * arena::ARENA_INITIAL_BLOCK_SIZE, 16))};
+    assert(is_aligned(large, 16));
+    std::fill(large, large + 4 * arena::ARENA_INITIAL_BLOCK_SIZE, std::byte{1});
+    for (int i = 0; i < 1000; ++i)
+        *static_cast<int *>(arena.allocate(sizeof(int), alignof(int))) = i;
+
+    // deallocating does nothing, release frees everything
+    arena.deallocate(large, 4 * arena::ARENA_INITIAL_BLOCK_SIZE, 16);
+    arena.release();
+    ctest::assert_equal(arena.allocated_bytes(), 0);
+    assert(is_aligned(arena.allocate(32, 32), 32));
+}
+
+void test_pool_resource()
+{
+    arena::PoolResource pool{};
+    void *const first{pool.allocate(24, 8)};
+    void *const second{pool.allocate(24, 8)};
+    assert(first != second);
+
+    // freed blocks are handed out again, to any size in the same class
+    pool.deallocate(first, 24, 8);
+    ctest::assert_equal(pool.allocate(32, 8), first);
+
+    // each block of a size class is aligned to its size, up to max_align_t
+    for (size_t size = 1; size <= arena::POOL_MAX_BLOCK_SIZE; size *= 2)
+    {
+        void *const block{pool.allocate(size, alignof(std::max_align_t))};
+        assert(is_aligned(block, alignof(std::max_align_t)));
+        pool.deallocate(block, size, alignof(std::max_align_t));
+        assert(is_aligned(pool.allocate(size, 1), std::min(size, alignof(std::max_align_t))));
+    }
+
+    // large and over aligned requests go to the upstream resource
+    void *const large{pool.allocate(4 * arena::POOL_MAX_BLOCK_SIZE, 16)};
+    void *const over_aligned{pool.allocate(64, 256)};
+    assert(is_aligned(over_aligned, 256));
+    pool.deallocate(large, 4 * arena::POOL_MAX_BLOCK_SIZE, 16);
+    pool.deallocate(over_aligned, 64, 256);
+
+    // more blocks than fit in one slab
+    for (size_t i = 0; i < 2 * arena::POOL_SLAB_SIZE / 64; ++i)
+        *static_cast<size_t *>(pool.allocate(64, 8)) = i;
+    pool.release();
+    assert(pool.allocate(24, 8));
+}
+
+void test_arena_containers()
+{
+    // everything a set allocates comes from the arena, none of it from the default resource
+    arena::MonotonicArena arena{};
+    {
+        const ctest::ScopedDefaultResource no_default_allocations{std::pmr::null_memory_resource()};
+        Set<int> set{std::identity(), set::HASHSET_INITIAL_SIZE, &arena};
+        for (int i = 0; i < 1000; ++i)
+            set.add(i);
+        set.remove(10);
+        ctest::assert_equal(set.size(), 999);
+        assert(!set.contains(10));
+        assert(set.contains(999));
+        assert(set.resource() == &arena);
+
+        // moving keeps the nodes in the arena
+        Set<int> moved{std::move(set)};
+        assert(moved.resource() == &arena);
+        assert(moved.contains(999));
+    }
+    assert(arena.allocated_bytes() > 0);
+}
+
+// Per request cost of building and destroying a short lived set, allocating from the heap, an arena released after
+// each request, or a pool reused by every request (this one and std::pmr::unsynchronized_pool_resource)
+void benchmark_arena()
+{
+    const int num_requests{20000};
+    const int items_per_request{64};
+    const auto run_request{[items_per_request](std::pmr::memory_resource *resource)
+                           {
+                               Set<int> set{std::identity(), set::HASHSET_INITIAL_SIZE, resource};
+                               for (int i = 0; i < items_per_request; ++i)
+                                   set.add(i);
+                               return set.size();
+                           }};
+
+    size_t heap_total{0};
+    const double heap_seconds{ctest::time_it([&]()
+                                             { for (int i = 0; i < num_requests; ++i)
+                                                   heap_total += run_request(std::pmr::get_default_resource()); })};
+    size_t arena_total{0};
+    arena::MonotonicArena arena{};
+    const double arena_seconds{ctest::time_it([&]()
+                                              { for (int i = 0; i < num_requests; ++i)
+                                                {
+                                                    arena_total += run_request(&arena);
+                                                    arena.release();
+                                                } })};
+    size_t pool_total{0};
+    arena::PoolResource pool{};
+    const double pool_seconds{ctest::time_it([&]()
+                                             { for (int i = 0; i < num_requests; ++i)
+                                                   pool_total += run_request(&pool); })};
+
+    // the standard library's equivalent, to check the custom pool is worth having
+    size_t std_pool_total{0};
+    std::pmr::unsynchronized_pool_resource std_pool{};
+    const double std_pool_seconds{ctest::time_it([&]()
+                                                 { for (int i = 0; i < num_requests; ++i)
+                                                       std_pool_total += run_request(&std_pool); })};
+    ctest::assert_equal(heap_total, arena_total);
+    ctest::assert_equal(heap_total, pool_total);
+    ctest::assert_equal(heap_total, std_pool_total);
+    std::cout << "ns per request: heap " << heap_seconds * 1e9 / num_requests << ", arena " << arena_seconds * 1e9 / num_requests
+              << ", pool " << pool_seconds * 1e9 / num_requests << " (std::pmr::unsynchronized_pool_resource " << std_pool_seconds * 1e9 / num_requests
+              << ")" << std::endl;
+}
+
+int main()
+{
+    test_monotonic_arena();
+    test_pool_resource();
+    test_arena_containers();
+    benchmark_arena();
+}
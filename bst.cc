@@ -1,19 +1,252 @@
 #include <vector>
+#include <memory_resource>
 #include <concepts>
 #include <optional>
 #include <assert.h>
 #include <iterator>
 #include <ranges>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include <bit>
+#include <random>
+#include <set>
 #include <cmath>
 #include <functional>
 #include "itertools.h"
+#include "arena.h"
 #include "ctest.h"
 
+// Read only sorted set laid out in Eytzinger (breadth first) order, i.e. a complete binary tree stored like a heap
+// layout[1] is the root and layout[k] has children layout[2k] and layout[2k + 1], with no gaps
+// The top levels of the tree are packed together so they stay in cache, and search is a branchless loop
+template <std::totally_ordered T>
+class StaticTree
+{
+public:
+    StaticTree() : StaticTree(std::vector<T>{}) {}
+
+    // build from any items, duplicates are only stored once
+    explicit StaticTree(std::vector<T> items) : layout{}
+    {
+        if (!std::ranges::is_sorted(items))
+            std::ranges::sort(items);
+        items.erase(std::unique(items.begin(), items.end()), items.end());
+        // layout[0] is unused so the child indices are a shift and add
+        layout.resize(items.size() + 1);
+        size_t next_item{0};
+        fill(1, items, next_item);
+    }
+
+    bool contains(const T &item) const
+    {
+        const size_t idx{lower_bound_idx(item)};
+        return idx != 0 && !(item < layout[idx]);
+    }
+
+    // the smallest item greater than or equal to item
+    std::optional<T> lower_bound(const T &item) const
+    {
+        const size_t idx{lower_bound_idx(item)};
+        return (idx == 0) ? std::nullopt : std::make_optional(layout[idx]);
+    }
+
+    size_t size() const { return layout.size() - 1; }
+
+    // number of edges on the path from the root to the deepest leaf, -1 for an empty tree
+    long height() const { return std::bit_width(size()) - 1; }
+
+    std::vector<T> inorder_traversal() const
+    {
+        std::vector<T> result{};
+        result.reserve(size());
+        inorder_traversal(1, result);
+        return result;
+    }
+
+private:
+    // number of items in a cache line, the descendants of node k that are this many levels down are contiguous
+    static constexpr size_t ITEMS_PER_CACHE_LINE{std::max<size_t>(1, 64 / sizeof(T))};
+
+    std::vector<T> layout;
+
+    // an in order walk of the implicit tree visits the slots in sorted order
+    void fill(const size_t idx, const std::vector<T> &sorted_items, size_t &next_item)
+    {
+        if (idx >= layout.size())
+            return;
+        fill(2 * idx, sorted_items, next_item);
+        layout[idx] = sorted_items[next_item++];
+        fill(2 * idx + 1, sorted_items, next_item);
+    }
+
+    // index of the smallest item >= item, or 0 if every item is smaller
+    size_t lower_bound_idx(const T &item) const
+    {
+        const size_t n{size()};
+        size_t idx{1};
+        while (idx <= n)
+        {
+            // fetch the descendants several levels down while this level is compared
+            __itertools_utils::prefetch(layout.data() + std::min(idx * ITEMS_PER_CACHE_LINE, n));
+            idx = 2 * idx + (layout[idx] < item);
+        }
+        // idx went right (appending a 1 bit) every time the node was smaller than item, and left after the answer
+        // so dropping the trailing 1s and the 0 before them gives the last node where it went left
+        return idx >> (std::countr_one(idx) + 1);
+    }
+
+    void inorder_traversal(const size_t idx, std::vector<T> &output_vec) const
+    {
+        if (idx >= layout.size())
+            return;
+
+        inorder_traversal(2 * idx, output_vec);
+        output_vec.push_back(layout[idx]);
+        inorder_traversal(2 * idx + 1, output_vec);
+    }
+};
+
+// Self balancing (AVL) binary search tree
+// Nodes are stored in one vector and refer to their children and parent by index, so there are no per node allocations,
+// memory is proportional to the number of items, and the tree stays O(log n) deep even for sorted input
+// Each node also stores the size and height of its subtree, so size, height, rank and select don't walk the tree
+// Iterating is done with the parent links, so no traversal needs recursion or a stack
 template <std::totally_ordered T>
 class BinaryTree
 {
+    static constexpr int32_t NO_NODE{-1};
+
 public:
-    BinaryTree() : items{} {};
+    // Walks the items in sorted order, an end iterator can be decremented to get the largest item
+    struct InorderIterator
+    {
+    public:
+        typedef T value_type;
+        typedef const T &reference;
+        typedef std::ptrdiff_t difference_type;
+        typedef std::bidirectional_iterator_tag iterator_category;
+
+        InorderIterator() : tree{nullptr}, node{NO_NODE} {}
+
+        InorderIterator(const BinaryTree *tree, const int32_t node) : tree{tree}, node{node} {}
+
+        reference operator*() const { return tree->nodes[node].item; }
+        const T *operator->() const { return &tree->nodes[node].item; }
+        InorderIterator &operator++()
+        {
+            node = tree->successor(node);
+            return *this;
+        }
+        InorderIterator operator++(int)
+        {
+            InorderIterator temp = *this;
+            ++*this;
+            return temp;
+        }
+        InorderIterator &operator--()
+        {
+            node = (node == NO_NODE) ? tree->rightmost(tree->root) : tree->predecessor(node);
+            return *this;
+        }
+        InorderIterator operator--(int)
+        {
+            InorderIterator temp = *this;
+            --*this;
+            return temp;
+        }
+        friend bool operator==(const InorderIterator &iter1, const InorderIterator &iter2) { return iter1.node == iter2.node; }
+        friend bool operator!=(const InorderIterator &iter1, const InorderIterator &iter2) { return !(iter1 == iter2); }
+
+    private:
+        const BinaryTree *tree;
+        int32_t node; // NO_NODE at the end
+    };
+
+    enum class Order
+    {
+        pre,
+        post,
+        level
+    };
+
+    // Walks the items in preorder, postorder or level order (breadth first)
+    // Level order visits each level with a walk from the root that stops at that level's depth,
+    // so it needs no queue, and in a balanced tree the walks add up to O(n) since each level doubles in size
+    template <Order order>
+    struct TraversalIterator
+    {
+    public:
+        typedef T value_type;
+        typedef const T &reference;
+        typedef std::ptrdiff_t difference_type;
+        typedef std::forward_iterator_tag iterator_category;
+
+        TraversalIterator() : tree{nullptr}, node{NO_NODE}, depth{0}, target_depth{0} {}
+
+        // the first item of the traversal
+        explicit TraversalIterator(const BinaryTree *tree) : tree{tree}, node{tree->root}, depth{0}, target_depth{0}
+        {
+            if constexpr (order == Order::post)
+                node = tree->first_postorder(node);
+        }
+
+        reference operator*() const { return tree->nodes[node].item; }
+        const T *operator->() const { return &tree->nodes[node].item; }
+        TraversalIterator &operator++()
+        {
+            if constexpr (order == Order::pre)
+                node = tree->next_preorder(node, depth, std::numeric_limits<int32_t>::max());
+            else if constexpr (order == Order::post)
+                node = tree->next_postorder(node);
+            else
+                next_level_order();
+            return *this;
+        }
+        TraversalIterator operator++(int)
+        {
+            TraversalIterator temp = *this;
+            ++*this;
+            return temp;
+        }
+        friend bool operator==(const TraversalIterator &iter1, const TraversalIterator &iter2) { return iter1.node == iter2.node; }
+        friend bool operator!=(const TraversalIterator &iter1, const TraversalIterator &iter2) { return !(iter1 == iter2); }
+
+    private:
+        const BinaryTree *tree;
+        int32_t node;         // NO_NODE at the end
+        int32_t depth;        // depth of node, only tracked for pre and level order
+        int32_t target_depth; // the level being visited in level order
+
+        void next_level_order()
+        {
+            // preorder walk that doesn't go below the target depth, stopping at the next node on that level
+            // once a level is finished start again from the root for the next one
+            do
+            {
+                node = tree->next_preorder(node, depth, target_depth);
+                if (node == NO_NODE && target_depth < tree->height())
+                {
+                    node = tree->root;
+                    depth = 0;
+                    ++target_depth;
+                }
+            } while (node != NO_NODE && depth != target_depth);
+        }
+    };
+
+    template <Order order>
+    using traversal_view = std::ranges::subrange<TraversalIterator<order>>;
+
+    typedef T value_type;
+    typedef InorderIterator iterator;
+    typedef InorderIterator const_iterator;
+
+    BinaryTree() : nodes{}, free_nodes{}, root{NO_NODE} {};
+
+    // allocate the nodes from resource, which must outlive the tree. Copies use the default resource
+    explicit BinaryTree(std::pmr::memory_resource *resource) : nodes{resource}, free_nodes{resource}, root{NO_NODE} {};
 
     template <std::ranges::input_range Iter>
         requires std::same_as<std::ranges::range_value_t<Iter>, T>
@@ -29,9 +262,7 @@ public:
 
     void add(const T &item)
     {
-        const size_t new_node_idx{find_node(item)};
-        if (!node_exists(new_node_idx))
-            add_node(new_node_idx, item);
+        set_root(insert(root, item));
     }
 
     template <std::input_iterator Iter>
@@ -42,87 +273,386 @@ public:
             add(*begin);
     }
 
-    bool contains(const T &item)
+    void remove(const T &item)
+    {
+        set_root(erase(root, item));
+    }
+
+    bool contains(const T &item) const
+    {
+        int32_t current_node{root};
+        while (current_node != NO_NODE)
+        {
+            const Node &node{nodes[current_node]};
+            if (item < node.item)
+                current_node = node.left;
+            else if (node.item < item)
+                current_node = node.right;
+            else
+                return true;
+        }
+        return false;
+    }
+
+    iterator begin() const { return InorderIterator(this, leftmost(root)); }
+    iterator end() const { return InorderIterator(this, NO_NODE); }
+
+    // the first item not less than item
+    iterator lower_bound(const T &item) const
+    {
+        int32_t found{NO_NODE};
+        int32_t current_node{root};
+        while (current_node != NO_NODE)
+        {
+            if (nodes[current_node].item < item)
+                current_node = nodes[current_node].right;
+            else
+            {
+                found = current_node;
+                current_node = nodes[current_node].left;
+            }
+        }
+        return InorderIterator(this, found);
+    }
+
+    // the items in [low, high), in sorted order
+    std::ranges::subrange<iterator> range(const T &low, const T &high) const
     {
-        return node_exists(find_node(item));
+        if (!(low < high))
+            return {end(), end()};
+        return {lower_bound(low), lower_bound(high)};
     }
 
-    // technically not preorder because it includes gaps
-    std::vector<std::optional<T>> preorder_traversal() const
+    traversal_view<Order::pre> preorder() const { return {TraversalIterator<Order::pre>(this), TraversalIterator<Order::pre>()}; }
+    traversal_view<Order::post> postorder() const { return {TraversalIterator<Order::post>(this), TraversalIterator<Order::post>()}; }
+    traversal_view<Order::level> level_order() const { return {TraversalIterator<Order::level>(this), TraversalIterator<Order::level>()}; }
+
+    std::vector<T> preorder_traversal() const
     {
-        return items;
+        std::vector<T> result{};
+        result.reserve(size());
+        std::ranges::copy(preorder(), std::back_inserter(result));
+        return result;
     }
 
     std::vector<T> inorder_traversal() const
     {
         std::vector<T> result{};
-        inorder_traversal(0, result);
+        result.reserve(size());
+        std::ranges::copy(*this, std::back_inserter(result));
         return result;
     }
 
-    // O(1) calculation of height
-    // uses the recurrence relation that Ri = 2*R(i-1) + 2, where Ri is the Rightmost node of level i (root is at level 0)
-    // algebra gives Ri = 2^(i+1) - 2
-    // gives i = log2(Ri + 2) - 1
-    // so i = ceil(log2(index of last node in tree + 2)) - 1  , taking the ceiling since if even one node is in a level, the tree has that height
-    long height() const
+    // number of edges on the longest path from the root to a leaf, -1 for an empty tree
+    long height() const { return get_height(root); }
+
+    // copy the items into a read only tree that is faster to search
+    StaticTree<T> freeze() const
     {
-        return std::lround(std::ceil(std::log2(items.size() + 1))) - 1;
+        return StaticTree<T>(inorder_traversal());
     }
 
-    // O(n) calculation of size (the number of nodes in the tree)
-    long size() const { return inorder_traversal().size(); }
+    long size() const { return get_count(root); }
+
+    bool empty() const { return root == NO_NODE; }
+
+    // number of items less than item, so the position item has or would have in inorder_traversal
+    long rank(const T &item) const
+    {
+        long smaller{0};
+        int32_t current_node{root};
+        while (current_node != NO_NODE)
+        {
+            const Node &node{nodes[current_node]};
+            if (node.item < item)
+            {
+                smaller += get_count(node.left) + 1;
+                current_node = node.right;
+            }
+            else
+                current_node = node.left;
+        }
+        return smaller;
+    }
+
+    // the item at this index of inorder_traversal
+    T select(long index) const
+    {
+        itertools::validate_index(index, size());
+        int32_t current_node{root};
+        while (true)
+        {
+            const Node &node{nodes[current_node]};
+            const long left_count{get_count(node.left)};
+            if (index < left_count)
+                current_node = node.left;
+            else if (index == left_count)
+                return node.item;
+            else
+            {
+                index -= left_count + 1;
+                current_node = node.right;
+            }
+        }
+    }
 
 private:
-    // items[0]: root
-    // items[1]: left node of root
-    // items[2]: right node of root
-    // items[2*i + 1]: left node of i
-    // items[2*i + 2]: right node of i
-    std::vector<std::optional<T>> items;
+    struct Node
+    {
+        T item;
+        int32_t left;
+        int32_t right;
+        int32_t parent;
+        int32_t height; // height of the subtree rooted at this node
+        int32_t count;  // number of nodes in the subtree rooted at this node
+    };
+
+    std::pmr::vector<Node> nodes;
+    std::pmr::vector<int32_t> free_nodes; // removed nodes, reused by later inserts
+    int32_t root;
 
-    size_t get_left(const size_t idx) const { return 2 * idx + 1; }
+    int32_t get_height(const int32_t idx) const { return (idx == NO_NODE) ? -1 : nodes[idx].height; }
 
-    size_t get_right(const size_t idx) const { return 2 * idx + 2; }
+    int32_t get_count(const int32_t idx) const { return (idx == NO_NODE) ? 0 : nodes[idx].count; }
 
-    bool node_exists(const size_t idx) const
+    // set the child links along with the child's parent link
+    void set_left(const int32_t idx, const int32_t child)
     {
-        return idx < items.size() && items[idx].has_value();
+        nodes[idx].left = child;
+        if (child != NO_NODE)
+            nodes[child].parent = idx;
     }
 
-    // find the idx of the given item in the tree
-    // if item doesn't exist in the tree, then return the index where it should be placed
-    size_t find_node(const T &item) const
+    void set_right(const int32_t idx, const int32_t child)
     {
-        size_t current_node{0};
-        while (node_exists(current_node))
+        nodes[idx].right = child;
+        if (child != NO_NODE)
+            nodes[child].parent = idx;
+    }
+
+    void set_root(const int32_t idx)
+    {
+        root = idx;
+        if (root != NO_NODE)
+            nodes[root].parent = NO_NODE;
+    }
+
+    // positive when the left subtree is taller
+    int32_t balance_factor(const int32_t idx) const { return get_height(nodes[idx].left) - get_height(nodes[idx].right); }
+
+    // recalculate the height and count of idx from its children
+    void update(const int32_t idx)
+    {
+        nodes[idx].height = 1 + std::max(get_height(nodes[idx].left), get_height(nodes[idx].right));
+        nodes[idx].count = 1 + get_count(nodes[idx].left) + get_count(nodes[idx].right);
+    }
+
+    int32_t new_node(const T &item)
+    {
+        if (!free_nodes.empty())
         {
-            const T current_val{items[current_node].value()};
-            if (item < current_val)
-                current_node = get_left(current_node);
-            else if (item == current_val)
-                return current_node;
-            else
-                current_node = get_right(current_node);
+            const int32_t idx{free_nodes.back()};
+            free_nodes.pop_back();
+            nodes[idx] = Node{item, NO_NODE, NO_NODE, NO_NODE, 0, 1};
+            return idx;
         }
-        return current_node;
+        if (nodes.size() == static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+            throw std::length_error("BinaryTree is full");
+        nodes.push_back(Node{item, NO_NODE, NO_NODE, NO_NODE, 0, 1});
+        return nodes.size() - 1;
     }
 
-    // add node to the tree, increasing the vector size if necessary
-    void add_node(const size_t idx, const T item)
+    // add item to the subtree rooted at idx, returning the index of the subtree's new root
+    int32_t insert(const int32_t idx, const T &item)
     {
-        items.resize(std::max(items.size(), idx + 1));
-        items[idx] = item;
+        if (idx == NO_NODE)
+            return new_node(item);
+        // nodes can be reallocated by the insert, so don't hold references to it across the call
+        if (item < nodes[idx].item)
+        {
+            const int32_t new_left{insert(nodes[idx].left, item)};
+            set_left(idx, new_left);
+        }
+        else if (nodes[idx].item < item)
+        {
+            const int32_t new_right{insert(nodes[idx].right, item)};
+            set_right(idx, new_right);
+        }
+        else
+            return idx;
+        return rebalance(idx);
     }
 
-    void inorder_traversal(const size_t start_idx, std::vector<T> &output_vec) const
+    // remove item from the subtree rooted at idx, returning the index of the subtree's new root
+    int32_t erase(const int32_t idx, const T &item)
     {
-        if (!node_exists(start_idx))
-            return;
+        if (idx == NO_NODE)
+            return NO_NODE;
+        Node &node{nodes[idx]};
+        if (item < node.item)
+            set_left(idx, erase(node.left, item));
+        else if (node.item < item)
+            set_right(idx, erase(node.right, item));
+        else if (node.left == NO_NODE || node.right == NO_NODE)
+        {
+            // with at most one child, the child takes this node's place
+            const int32_t child{(node.left == NO_NODE) ? node.right : node.left};
+            free_nodes.push_back(idx);
+            return child;
+        }
+        else
+        {
+            // with two children, take the next item in order's place, then remove that item from the right subtree
+            int32_t successor{node.right};
+            while (nodes[successor].left != NO_NODE)
+                successor = nodes[successor].left;
+            node.item = nodes[successor].item;
+            set_right(idx, erase(node.right, node.item));
+        }
+        return rebalance(idx);
+    }
+
+    // the left child becomes the root of the subtree, with idx as its right child
+    // the left child's old right subtree becomes idx's left subtree, so the order of items is unchanged
+    int32_t rotate_right(const int32_t idx)
+    {
+        const int32_t left{nodes[idx].left};
+        set_left(idx, nodes[left].right);
+        set_right(left, idx);
+        update(idx);
+        update(left);
+        return left;
+    }
 
-        inorder_traversal(get_left(start_idx), output_vec);
-        output_vec.push_back(items[start_idx].value());
-        inorder_traversal(get_right(start_idx), output_vec);
+    int32_t rotate_left(const int32_t idx)
+    {
+        const int32_t right{nodes[idx].right};
+        set_right(idx, nodes[right].left);
+        set_left(right, idx);
+        update(idx);
+        update(right);
+        return right;
+    }
+
+    // restore the AVL property (child heights differ by at most 1) at idx, returning the subtree's new root
+    int32_t rebalance(const int32_t idx)
+    {
+        update(idx);
+        const int32_t balance{balance_factor(idx)};
+        if (balance > 1)
+        {
+            if (balance_factor(nodes[idx].left) < 0)
+                set_left(idx, rotate_left(nodes[idx].left));
+            return rotate_right(idx);
+        }
+        if (balance < -1)
+        {
+            if (balance_factor(nodes[idx].right) > 0)
+                set_right(idx, rotate_right(nodes[idx].right));
+            return rotate_left(idx);
+        }
+        return idx;
+    }
+
+    int32_t leftmost(int32_t idx) const
+    {
+        if (idx == NO_NODE)
+            return NO_NODE;
+        while (nodes[idx].left != NO_NODE)
+            idx = nodes[idx].left;
+        return idx;
+    }
+
+    int32_t rightmost(int32_t idx) const
+    {
+        if (idx == NO_NODE)
+            return NO_NODE;
+        while (nodes[idx].right != NO_NODE)
+            idx = nodes[idx].right;
+        return idx;
+    }
+
+    // the next node in sorted order, or NO_NODE after the last one
+    int32_t successor(int32_t idx) const
+    {
+        if (nodes[idx].right != NO_NODE)
+            return leftmost(nodes[idx].right);
+        // otherwise it's the first ancestor whose left subtree we are in
+        int32_t parent{nodes[idx].parent};
+        while (parent != NO_NODE && nodes[parent].right == idx)
+        {
+            idx = parent;
+            parent = nodes[idx].parent;
+        }
+        return parent;
+    }
+
+    int32_t predecessor(int32_t idx) const
+    {
+        if (nodes[idx].left != NO_NODE)
+            return rightmost(nodes[idx].left);
+        int32_t parent{nodes[idx].parent};
+        while (parent != NO_NODE && nodes[parent].left == idx)
+        {
+            idx = parent;
+            parent = nodes[idx].parent;
+        }
+        return parent;
+    }
+
+    // the next node in preorder, not going deeper than max_depth, and updating depth to the depth of the node returned
+    int32_t next_preorder(int32_t idx, int32_t &depth, const int32_t max_depth) const
+    {
+        if (depth < max_depth)
+        {
+            if (nodes[idx].left != NO_NODE)
+            {
+                ++depth;
+                return nodes[idx].left;
+            }
+            if (nodes[idx].right != NO_NODE)
+            {
+                ++depth;
+                return nodes[idx].right;
+            }
+        }
+        // go back up to the first ancestor that has a right subtree we haven't visited
+        int32_t parent{nodes[idx].parent};
+        while (parent != NO_NODE)
+        {
+            if (nodes[parent].left == idx && nodes[parent].right != NO_NODE)
+                return nodes[parent].right;
+            idx = parent;
+            parent = nodes[idx].parent;
+            --depth;
+        }
+        return NO_NODE;
+    }
+
+    // the first node in postorder of the subtree rooted at idx, the leaf found by going left whenever possible
+    int32_t first_postorder(int32_t idx) const
+    {
+        while (idx != NO_NODE)
+        {
+            if (nodes[idx].left != NO_NODE)
+                idx = nodes[idx].left;
+            else if (nodes[idx].right != NO_NODE)
+                idx = nodes[idx].right;
+            else
+                return idx;
+        }
+        return NO_NODE;
+    }
+
+    int32_t next_postorder(const int32_t idx) const
+    {
+        const int32_t parent{nodes[idx].parent};
+        if (parent == NO_NODE)
+            return NO_NODE;
+        // after a left subtree comes the right subtree, after that the parent itself
+        if (nodes[parent].left == idx && nodes[parent].right != NO_NODE)
+            return first_postorder(nodes[parent].right);
+        return parent;
     }
 };
 
@@ -139,10 +669,23 @@ void test_bst_add()
     bst.add(2);
     bst.add(5);
     bst.add(0);
-    ctest::assert_equal(bst.preorder_traversal(), std::vector<std::optional<int>>{{2}, {0}, {5}});
+    ctest::assert_equal(bst.preorder_traversal(), std::vector<int>{2, 0, 5});
     bst.add(3);
     bst.add(1);
-    ctest::assert_equal(bst.preorder_traversal(), std::vector<std::optional<int>>{{2}, {0}, {5}, {}, {1}, {3}});
+    ctest::assert_equal(bst.preorder_traversal(), std::vector<int>{2, 0, 1, 5, 3});
+
+    // duplicates aren't added twice
+    bst.add(3);
+    ctest::assert_equal(bst.size(), 5);
+}
+
+void test_bst_rotations()
+{
+    // each of the 4 unbalanced shapes is rotated so the middle item becomes the root
+    ctest::assert_equal((BinaryTree{3, 2, 1}).preorder_traversal(), std::vector<int>{2, 1, 3});
+    ctest::assert_equal((BinaryTree{1, 2, 3}).preorder_traversal(), std::vector<int>{2, 1, 3});
+    ctest::assert_equal((BinaryTree{3, 1, 2}).preorder_traversal(), std::vector<int>{2, 1, 3});
+    ctest::assert_equal((BinaryTree{1, 3, 2}).preorder_traversal(), std::vector<int>{2, 1, 3});
 }
 
 void test_bst_outstream()
@@ -153,7 +696,7 @@ void test_bst_outstream()
     bst.add(0);
     bst.add(3);
     bst.add(1);
-    ctest::assert_outstream(bst, "[ 2 0 5 None 1 3 ]");
+    ctest::assert_outstream(bst, "[ 2 0 1 5 3 ]");
 }
 
 void test_bst_contains()
@@ -178,14 +721,269 @@ void test_bst_inorder_traversal()
 
 void test_bst_height()
 {
-    // height of an empty tree is undefined I guess assert((BinaryTree<int>{}).height() == 0);
+    ctest::assert_equal((BinaryTree<int>{}).height(), -1);
     ctest::assert_equal((BinaryTree{1}).height(), 0);
     ctest::assert_equal((BinaryTree{3, 0, 5}).height(), 1);
-    ctest::assert_equal((BinaryTree{3, 0, 5, 6, 7, 8}).height(), 4);
+    ctest::assert_equal((BinaryTree{3, 0, 5, 6, 7, 8}).height(), 2);
     BinaryTree tree4{10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 11, 15, 13, 14};
     long height{tree4.height()};
-    ctest::assert_equal(height, 9);
-    ctest::assert_equal((BinaryTree{10, 1, 9, 2, 8, 3, 7, 4, 6, 5, 11, 15, 13, 14}).height(), 9);
+    ctest::assert_equal(height, 3);
+    ctest::assert_equal((BinaryTree{10, 1, 9, 2, 8, 3, 7, 4, 6, 5, 11, 15, 13, 14}).height(), 3);
+}
+
+void test_bst_sorted_input()
+{
+    // sorted input used to make a chain, now it gives a perfectly balanced tree
+    BinaryTree<int> ascending(itertools::range(0, 1 << 20));
+    ctest::assert_equal(ascending.size(), 1 << 20);
+    ctest::assert_equal(ascending.height(), 20);
+    BinaryTree<int> descending(itertools::range(1 << 20, 0, -1));
+    ctest::assert_equal(descending.height(), 20);
+    for (const int item : {0, 1, 12345, (1 << 20) - 1})
+        assert(ascending.contains(item));
+    assert(!ascending.contains(-1));
+    assert(!ascending.contains(1 << 20));
+}
+
+void test_bst_remove()
+{
+    BinaryTree<int> bst{5, 2, 8, 1, 3, 7, 9};
+    bst.remove(1); // leaf
+    ctest::assert_equal(bst.inorder_traversal(), std::vector<int>{2, 3, 5, 7, 8, 9});
+    bst.remove(2); // one child
+    ctest::assert_equal(bst.inorder_traversal(), std::vector<int>{3, 5, 7, 8, 9});
+    bst.remove(5); // two children, at the root
+    ctest::assert_equal(bst.inorder_traversal(), std::vector<int>{3, 7, 8, 9});
+    bst.remove(100); // no error for missing items
+    ctest::assert_equal(bst.size(), 4);
+    assert(!bst.contains(5));
+    assert(bst.contains(7));
+
+    for (const int item : {3, 7, 8, 9})
+        bst.remove(item);
+    ctest::assert_equal(bst.size(), 0);
+    ctest::assert_equal(bst.height(), -1);
+    ctest::assert_equal(bst.inorder_traversal(), std::vector<int>{});
+
+    // removed nodes are reused
+    bst.add(4);
+    bst.add(6);
+    ctest::assert_equal(bst.preorder_traversal(), std::vector<int>{4, 6});
+}
+
+void test_bst_rank_select()
+{
+    BinaryTree<int> bst{50, 20, 80, 10, 30, 70, 90};
+    ctest::assert_equal(bst.rank(10), 0);
+    ctest::assert_equal(bst.rank(50), 3);
+    ctest::assert_equal(bst.rank(55), 4);
+    ctest::assert_equal(bst.rank(0), 0);
+    ctest::assert_equal(bst.rank(100), 7);
+    ctest::assert_equal(bst.select(0), 10);
+    ctest::assert_equal(bst.select(3), 50);
+    ctest::assert_equal(bst.select(6), 90);
+    ctest::raises<std::range_error>([&bst]()
+                                    { bst.select(7); });
+    ctest::raises<std::range_error>([&bst]()
+                                    { bst.select(-1); });
+}
+
+// checks the AVL property and the stored heights and counts of every node against the items
+void check_tree(const BinaryTree<int> &tree, const std::set<int> &expected)
+{
+    ctest::assert_equal(tree.size(), expected.size());
+    ctest::assert_equal(tree.inorder_traversal(), std::vector<int>(expected.begin(), expected.end()));
+    // an AVL tree of n nodes is at most 1.44 log2(n + 2) high
+    assert(tree.height() <= 1.45 * std::log2(expected.size() + 2));
+    long index{0};
+    for (const int item : expected)
+    {
+        ctest::assert_equal(tree.rank(item), index);
+        ctest::assert_equal(tree.select(index), item);
+        ++index;
+    }
+}
+
+void test_bst_random_operations()
+{
+    std::mt19937 generator{5};
+    std::uniform_int_distribution<int> distribution{0, 2000};
+    BinaryTree<int> tree{};
+    std::set<int> expected{};
+    for (int round = 0; round < 10; ++round)
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            const int item{distribution(generator)};
+            if (generator() % 3 == 0)
+            {
+                tree.remove(item);
+                expected.erase(item);
+            }
+            else
+            {
+                tree.add(item);
+                expected.insert(item);
+            }
+        }
+        check_tree(tree, expected);
+    }
+}
+
+void test_bst_iterator()
+{
+    static_assert(std::ranges::bidirectional_range<BinaryTree<int>>);
+    BinaryTree<int> bst{10, 1, 9, 2, 8, 3, 7, 4, 6, 5};
+    ctest::assert_equal(std::vector<int>(bst.begin(), bst.end()), std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+
+    std::vector<int> reversed{};
+    for (auto iter = bst.end(); iter != bst.begin();)
+        reversed.push_back(*--iter);
+    ctest::assert_equal(reversed, std::vector<int>{10, 9, 8, 7, 6, 5, 4, 3, 2, 1});
+    ctest::assert_equal(*std::ranges::max_element(bst), 10);
+    ctest::assert_equal(std::ranges::distance(bst), 10);
+
+    BinaryTree<int> empty{};
+    assert(empty.begin() == empty.end());
+    assert(empty.preorder().empty());
+    assert(empty.postorder().empty());
+    assert(empty.level_order().empty());
+
+    // iterators stay in order as items are removed
+    bst.remove(5);
+    bst.remove(1);
+    ctest::assert_equal(std::vector<int>(bst.begin(), bst.end()), std::vector<int>{2, 3, 4, 6, 7, 8, 9, 10});
+}
+
+void test_bst_traversal_orders()
+{
+    // 4 is the root with children 2 and 6, their children are 1, 3 and 5, 7, and 8 is the right child of 7
+    BinaryTree<int> bst{4, 2, 6, 1, 3, 5, 7, 8};
+    ctest::assert_equal(bst.preorder_traversal(), std::vector<int>{4, 2, 1, 3, 6, 5, 7, 8});
+    ctest::assert_equal(std::vector<int>(bst.preorder().begin(), bst.preorder().end()), std::vector<int>{4, 2, 1, 3, 6, 5, 7, 8});
+    ctest::assert_equal(std::vector<int>(bst.postorder().begin(), bst.postorder().end()), std::vector<int>{1, 3, 2, 5, 8, 7, 6, 4});
+    ctest::assert_equal(std::vector<int>(bst.level_order().begin(), bst.level_order().end()), std::vector<int>{4, 2, 6, 1, 3, 5, 7, 8});
+
+    BinaryTree<int> single{1};
+    ctest::assert_equal(std::ranges::distance(single.level_order()), 1);
+    ctest::assert_equal(std::ranges::distance(single.postorder()), 1);
+}
+
+void test_bst_range()
+{
+    BinaryTree<int> bst(itertools::range(0, 100, 5));
+    ctest::assert_equal(*bst.lower_bound(10), 10);
+    ctest::assert_equal(*bst.lower_bound(11), 15);
+    assert(bst.lower_bound(96) == bst.end());
+
+    std::vector<int> in_range{};
+    for (const int item : bst.range(12, 31))
+        in_range.push_back(item);
+    ctest::assert_equal(in_range, std::vector<int>{15, 20, 25, 30});
+    assert(bst.range(31, 12).empty());
+    assert(bst.range(96, 200).empty());
+    ctest::assert_equal(std::ranges::distance(bst.range(-10, 200)), 20);
+}
+
+void test_bst_traversals_large()
+{
+    // deep enough that recursive traversals would be noticeable, and checked against the sorted order
+    std::vector<int> shuffled{itertools::range(0, 100000)};
+    std::ranges::shuffle(shuffled, std::mt19937{9});
+    BinaryTree<int> bst(shuffled);
+    ctest::assert_equal(std::ranges::distance(bst.preorder()), 100000);
+    ctest::assert_equal(std::ranges::distance(bst.postorder()), 100000);
+    ctest::assert_equal(std::ranges::distance(bst.level_order()), 100000);
+    // the root comes first in preorder and level order, and last in postorder
+    const int root{*bst.preorder().begin()};
+    ctest::assert_equal(*bst.level_order().begin(), root);
+    int last_postorder{-1};
+    for (const int item : bst.postorder())
+        last_postorder = item;
+    ctest::assert_equal(last_postorder, root);
+    long sum{0};
+    for (const int item : bst.level_order())
+        sum += item;
+    ctest::assert_equal(sum, 99999L * 100000L / 2);
+}
+
+void test_static_tree()
+{
+    StaticTree<int> empty{};
+    ctest::assert_equal(empty.size(), 0);
+    ctest::assert_equal(empty.height(), -1);
+    assert(!empty.contains(0));
+    assert(!empty.lower_bound(0));
+
+    BinaryTree<int> tree{10, 1, 9, 2, 8, 3, 7, 4, 6, 5, 11, 15, 13, 14};
+    const StaticTree<int> frozen{tree.freeze()};
+    ctest::assert_equal(frozen.size(), 14);
+    ctest::assert_equal(frozen.height(), 3);
+    ctest::assert_equal(frozen.inorder_traversal(), tree.inorder_traversal());
+    for (const int item : tree.inorder_traversal())
+        assert(frozen.contains(item));
+    assert(!frozen.contains(0));
+    assert(!frozen.contains(12));
+    assert(!frozen.contains(16));
+
+    ctest::assert_equal(frozen.lower_bound(0), 1);
+    ctest::assert_equal(frozen.lower_bound(12), 13);
+    ctest::assert_equal(frozen.lower_bound(15), 15);
+    assert(!frozen.lower_bound(16));
+
+    // unsorted input with duplicates
+    const StaticTree<int> built{std::vector<int>{5, 3, 5, 1, 3}};
+    ctest::assert_equal(built.inorder_traversal(), std::vector<int>{1, 3, 5});
+}
+
+void test_static_tree_matches_binary_tree()
+{
+    std::mt19937 generator{7};
+    std::uniform_int_distribution<int> distribution{0, 20000};
+    BinaryTree<int> tree{};
+    for (int i = 0; i < 5000; ++i)
+        tree.add(distribution(generator));
+    const StaticTree<int> frozen{tree.freeze()};
+    const std::vector<int> sorted{tree.inorder_traversal()};
+    for (int item = -1; item <= 20001; ++item)
+    {
+        ctest::assert_equal(frozen.contains(item), tree.contains(item));
+        const auto expected{std::ranges::lower_bound(sorted, item)};
+        if (expected == sorted.end())
+            assert(!frozen.lower_bound(item));
+        else
+            ctest::assert_equal(frozen.lower_bound(item), *expected);
+    }
+}
+
+void benchmark_static_tree()
+{
+    const int num_items{1 << 22};
+    std::vector<int> items{itertools::range(0, 2 * num_items, 2)};
+    const BinaryTree<int> tree(items);
+    const StaticTree<int> frozen{tree.freeze()};
+
+    std::mt19937 generator{42};
+    std::uniform_int_distribution<int> distribution{0, 2 * num_items};
+    std::vector<int> queries(1 << 20);
+    for (int &query : queries)
+        query = distribution(generator);
+
+    long tree_found{0};
+    long frozen_found{0};
+    long sorted_found{0};
+    const double tree_seconds{ctest::time_it([&]()
+                                             { for (const int query : queries) tree_found += tree.contains(query); })};
+    const double frozen_seconds{ctest::time_it([&]()
+                                               { for (const int query : queries) frozen_found += frozen.contains(query); })};
+    const double sorted_seconds{ctest::time_it([&]()
+                                               { for (const int query : queries) sorted_found += std::ranges::binary_search(items, query); })};
+    ctest::assert_equal(tree_found, frozen_found);
+    ctest::assert_equal(tree_found, sorted_found);
+
+    const double count(queries.size());
+    std::cout << "ns per lookup: BinaryTree " << tree_seconds * 1e9 / count << ", StaticTree " << frozen_seconds * 1e9 / count
+              << ", sorted vector " << sorted_seconds * 1e9 / count << std::endl;
 }
 
 void test_bst_size()
@@ -197,12 +995,41 @@ void test_bst_size()
     ctest::assert_equal((BinaryTree{10, 1, 9, 2, 8, 3, 7, 4, 6, 5, 11, 15, 13, 14}).size(), 14);
 }
 
+void test_bst_memory_resource()
+{
+    arena::MonotonicArena arena{};
+    {
+        const ctest::ScopedDefaultResource no_default_allocations{std::pmr::null_memory_resource()};
+        BinaryTree<int> tree{&arena};
+        for (const int i : itertools::range(0, 1000))
+            tree.add(i);
+        tree.remove(500);
+        ctest::assert_equal(tree.size(), 999);
+        assert(!tree.contains(500));
+        assert(tree.contains(501));
+    }
+    assert(arena.allocated_bytes() > 0);
+}
+
 int main()
 {
     test_bst_add();
+    test_bst_rotations();
     test_bst_outstream();
     test_bst_contains();
     test_bst_inorder_traversal();
     test_bst_height();
+    test_bst_sorted_input();
     test_bst_size();
+    test_bst_memory_resource();
+    test_bst_remove();
+    test_bst_rank_select();
+    test_bst_random_operations();
+    test_bst_iterator();
+    test_bst_traversal_orders();
+    test_bst_range();
+    test_bst_traversals_large();
+    test_static_tree();
+    test_static_tree_matches_binary_tree();
+    benchmark_static_tree();
 }
\ No newline at end of file
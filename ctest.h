@@ -7,6 +7,11 @@
 #include <sstream>
 #include <string>
 #include <concepts>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <memory_resource>
+#include <assert.h>
 #include "strlib.h"
 
 namespace testutils
@@ -14,9 +19,15 @@ namespace testutils
     template <typename T>
     std::string get_outstream(const T &value)
     {
-        std::ostringstream stream{};
-        stream << value;
-        return stream.str();
+        // numbers don't need a stream to be printed
+        if constexpr (__strlib_utils::Number<T>)
+            return strlib::to_str(value);
+        else
+        {
+            std::ostringstream stream{};
+            stream << value;
+            return stream.str();
+        }
     }
 }
 
@@ -45,6 +56,48 @@ namespace ctest
         assert(oustream_result == expected_result);
     }
 
+    // Time the callback, returning the average number of seconds taken over the given number of repeats
+    template <typename Func>
+        requires std::invocable<Func>
+    double time_it(const Func &callback, const int repeats = 1)
+    {
+        const std::chrono::time_point start{std::chrono::steady_clock::now()};
+        for (int i = 0; i < repeats; ++i)
+            callback();
+        const std::chrono::duration<double> elapsed_seconds{std::chrono::steady_clock::now() - start};
+        return elapsed_seconds.count() / repeats;
+    }
+
+    // threads the concurrency tests run at once, more than most test machines have cores so they are interleaved
+    constexpr int NUM_THREADS{8};
+
+    // run function(thread) on NUM_THREADS threads at once, thread being 0 to NUM_THREADS - 1, and wait for them all
+    template <typename Function>
+    void run_threads(const Function &function)
+    {
+        std::vector<std::thread> threads{};
+        for (int thread = 0; thread < NUM_THREADS; ++thread)
+            threads.emplace_back(function, thread);
+        for (std::thread &thread : threads)
+            thread.join();
+    }
+
+    // Make resource the default memory resource until this goes out of scope, then restore the previous one, even if a
+    // test throws. With std::pmr::null_memory_resource(), anything allocated from the default resource throws bad_alloc
+    class ScopedDefaultResource
+    {
+    public:
+        explicit ScopedDefaultResource(std::pmr::memory_resource *resource) : previous{std::pmr::set_default_resource(resource)} {}
+
+        ScopedDefaultResource(const ScopedDefaultResource &other) = delete;
+        ScopedDefaultResource &operator=(const ScopedDefaultResource &other) = delete;
+
+        ~ScopedDefaultResource() { std::pmr::set_default_resource(previous); }
+
+    private:
+        std::pmr::memory_resource *previous;
+    };
+
     template <typename T1, typename T2>
         requires std::equality_comparable_with<T1, T2>
     void assert_equal(const T1 &left, const T2 &right)
@@ -1,7 +1,9 @@
 #include <assert.h>
 #include <vector>
 #include <optional>
+#include <memory_resource>
 #include "doubly_linked_list.h"
+#include "arena.h"
 #include "ctest.h"
 
 void test_linked_list_add()
@@ -121,6 +123,259 @@ void test_linked_list_end_manipulation()
     ctest::assert_equal(list.size(), 3);
 }
 
+void test_linked_list_tracked_nodes()
+{
+    LinkedList<int> list{};
+    DoubleNode<int> *first{list.add_and_track(1)};
+    DoubleNode<int> *second{list.add_and_track(2)};
+    // enough nodes to need several slabs, tracked nodes don't move as the pool grows
+    for (int i = 3; i < 1000; ++i)
+        list.add(i);
+    ctest::assert_equal(first->item, 1);
+    ctest::assert_equal(second->item, 2);
+    list.remove(second);
+    ctest::assert_equal(list.size(), 998);
+    ctest::assert_equal(list[1], 3);
+
+    // removed nodes are reused for the next add
+    DoubleNode<int> *reused{list.add_and_track(2000)};
+    assert(reused == second);
+    ctest::assert_equal(list.back(), 2000);
+
+    // moving the list keeps the nodes where they are
+    LinkedList<int> moved{std::move(list)};
+    ctest::assert_equal(first->item, 1);
+    moved.remove(first);
+    ctest::assert_equal(moved.front(), 3);
+    ctest::assert_equal(list.size(), 0);
+}
+
+void test_linked_list_copy()
+{
+    LinkedList<int> list{1, 2, 3};
+    LinkedList<int> copy{list};
+    copy.add(4);
+    list.pop_left();
+    ctest::assert_equal(list.items(), std::vector<int>{2, 3});
+    ctest::assert_equal(copy.items(), std::vector<int>{1, 2, 3, 4});
+
+    copy = list;
+    ctest::assert_equal(copy.items(), std::vector<int>{2, 3});
+    copy.reverse();
+    ctest::assert_equal(list.items(), std::vector<int>{2, 3});
+    ctest::assert_equal(copy.items(), std::vector<int>{3, 2});
+}
+
+void test_linked_list_clear()
+{
+    LinkedList<int> list{1, 2, 3};
+    list.clear();
+    assert(!list);
+    ctest::assert_equal(list.items(), std::vector<int>{});
+    list.add_left(4);
+    list.add(5);
+    ctest::assert_equal(list.items(), std::vector<int>{4, 5});
+}
+
+void test_linked_list_splice()
+{
+    LinkedList<int> list{1, 2};
+    LinkedList<int> other{3, 4};
+    DoubleNode<int> *const tracked{other.add_and_track(5)};
+    list.splice(other);
+    ctest::assert_equal(list.items(), std::vector<int>{1, 2, 3, 4, 5});
+    ctest::assert_equal(list.back(), 5);
+    assert(!other);
+    ctest::assert_equal(other.items(), std::vector<int>{});
+
+    // nodes from other now belong to list, and other can still be used
+    list.remove(tracked);
+    other.add(6);
+    ctest::assert_equal(list.items(), std::vector<int>{1, 2, 3, 4});
+    ctest::assert_equal(other.items(), std::vector<int>{6});
+
+    list.splice_left(other);
+    ctest::assert_equal(list.items(), std::vector<int>{6, 1, 2, 3, 4});
+    ctest::assert_equal(list.size(), 5);
+    ctest::assert_equal(list.pop_left(), 6);
+
+    // splicing into and from empty lists
+    LinkedList<int> empty{};
+    empty.splice_left(list);
+    ctest::assert_equal(empty.items(), std::vector<int>{1, 2, 3, 4});
+    ctest::assert_equal(empty.back(), 4);
+    empty.splice(list);
+    ctest::assert_equal(empty.size(), 4);
+    empty.reverse();
+    ctest::assert_equal(empty.items(), std::vector<int>{4, 3, 2, 1});
+}
+
+void test_linked_list_splice_range()
+{
+    LinkedList<int> list{1, 2};
+    LinkedList<int> other{3};
+    DoubleNode<int> *const four{other.add_and_track(4)};
+    DoubleNode<int> *const five{other.add_and_track(5)};
+    other.add(6);
+
+    // move 4 and 5 to after 1, the nodes are relinked so the tracked pointers now refer to list
+    list.splice(list.before_begin()->next_node, other, four, five);
+    ctest::assert_equal(list.items(), std::vector<int>{1, 4, 5, 2});
+    ctest::assert_equal(other.items(), std::vector<int>{3, 6});
+    ctest::assert_equal(list.size(), 4);
+    ctest::assert_equal(other.size(), 2);
+    list.remove(four);
+    ctest::assert_equal(list.items(), std::vector<int>{1, 5, 2});
+
+    // the lists share a pool now, and both can still add and remove items
+    assert(list.node_pool() == other.node_pool());
+    other.add(7);
+    list.add(8);
+    ctest::assert_equal(other.pop_left(), 3);
+    ctest::assert_equal(other.items(), std::vector<int>{6, 7});
+
+    // moving the end of a list updates both lists' last items
+    DoubleNode<int> *const eight{list.add_and_track(9)->prev_node};
+    list.splice(list.before_begin(), list, eight, eight->next_node);
+    ctest::assert_equal(list.items(), std::vector<int>{8, 9, 1, 5, 2});
+    ctest::assert_equal(list.back(), 2);
+    list.splice(list.before_begin(), other, other.before_begin()->next_node->next_node, other.before_begin()->next_node->next_node);
+    ctest::assert_equal(list.items(), std::vector<int>{7, 8, 9, 1, 5, 2});
+    ctest::assert_equal(other.back(), 6);
+    other.add(10);
+    ctest::assert_equal(other.items(), std::vector<int>{6, 10});
+    list.reverse();
+    ctest::assert_equal(list.items(), std::vector<int>{2, 5, 1, 9, 8, 7});
+}
+
+void test_linked_list_shared_pool()
+{
+    LinkedList<int> first{};
+    LinkedList<int> second{first.node_pool()};
+    for (int i = 0; i < 100; ++i)
+    {
+        first.add(i);
+        second.add(-i);
+    }
+    // whole lists and ranges move between lists sharing a pool without joining or copying anything
+    DoubleNode<int> *const tracked{second.add_and_track(-100)};
+    first.splice_left(second);
+    ctest::assert_equal(first.size(), 201);
+    ctest::assert_equal(first.front(), 0);
+    ctest::assert_equal(first.back(), 99);
+    first.remove(tracked);
+
+    // a list destroyed or cleared while its pool is shared gives its nodes back, instead of freeing the slabs
+    {
+        LinkedList<int> temporary{first.node_pool()};
+        temporary.add(1);
+        second.splice(first);
+        second.clear();
+        second.add(2);
+        temporary.splice(second);
+        ctest::assert_equal(temporary.items(), std::vector<int>{1, 2});
+    }
+    first.add(3);
+    ctest::assert_equal(first.items(), std::vector<int>{3});
+    ctest::assert_equal(second.size(), 0);
+}
+
+void test_linked_list_merge()
+{
+    LinkedList<int> list{1, 3, 3, 8};
+    LinkedList<int> other{0, 2, 3, 9, 10};
+    list.merge(other);
+    ctest::assert_equal(list.items(), std::vector<int>{0, 1, 2, 3, 3, 3, 8, 9, 10});
+    ctest::assert_equal(list.size(), 9);
+    ctest::assert_equal(list.back(), 10);
+    assert(!other);
+    list.add(11);
+    other.add(1);
+    ctest::assert_equal(other.items(), std::vector<int>{1});
+    list.reverse();
+    ctest::assert_equal(list.front(), 11);
+    ctest::assert_equal(list.back(), 0);
+
+    // equal items from this list come first
+    LinkedList<int> tens{10, 20};
+    LinkedList<int> more_tens{11, 21};
+    tens.merge(more_tens, [](const int a, const int b)
+               { return a / 10 < b / 10; });
+    ctest::assert_equal(tens.items(), std::vector<int>{10, 11, 20, 21});
+
+    // merging into an empty list, and with a different order
+    LinkedList<int> empty{};
+    LinkedList<int> descending{5, 3, 1};
+    empty.merge(descending, std::greater<int>());
+    ctest::assert_equal(empty.items(), std::vector<int>{5, 3, 1});
+    ctest::assert_equal(empty.back(), 1);
+}
+
+void test_linked_list_memory_resource()
+{
+    arena::MonotonicArena arena1{}, arena2{};
+    LinkedList<int> list{{1, 2, 3}, &arena1};
+    assert(list.resource() == &arena1);
+    for (int i = 4; i <= 100; ++i)
+        list.add(i);
+    ctest::assert_equal(list.size(), 100);
+    const size_t allocated{arena1.allocated_bytes()};
+    assert(allocated > 0);
+
+    // splicing from the same resource moves the nodes, from another resource copies the items
+    LinkedList<int> same{{101}, &arena1};
+    LinkedList<int> other{{0}, &arena2};
+    list.splice(same);
+    list.splice_left(other);
+    ctest::assert_equal(list.size(), 102);
+    ctest::assert_equal(list.front(), 0);
+    ctest::assert_equal(list.back(), 101);
+    assert(!other);
+    assert(other.resource() == &arena2);
+
+    // lists with different resources can't share a pool, so splicing and merging copy the items into new nodes
+    // and release other's nodes, invalidating pointers to them
+    LinkedList<int> from_arena2{{-1}, &arena2};
+    DoubleNode<int> *const middle{from_arena2.add_and_track(-2)};
+    from_arena2.add(-3);
+    list.splice(list.before_begin(), from_arena2, middle, middle);
+    ctest::assert_equal(list.front(), -2);
+    ctest::assert_equal(list.size(), 103);
+    ctest::assert_equal(from_arena2.items(), std::vector<int>{-1, -3});
+    list.splice(from_arena2);
+    ctest::assert_equal(list.size(), 105);
+    ctest::assert_equal(list.back(), -3);
+    assert(list.node_pool() != from_arena2.node_pool());
+    LinkedList<int> sorted{{1, 2}, &arena1};
+    LinkedList<int> sorted_arena2{{0, 3}, &arena2};
+    sorted.merge(sorted_arena2);
+    ctest::assert_equal(sorted.items(), std::vector<int>{0, 1, 2, 3});
+    ctest::assert_equal(sorted.back(), 3);
+    assert(!sorted_arena2);
+    assert(sorted.resource() == &arena1);
+
+    // copies use the default resource
+    LinkedList<int> copy{list};
+    assert(copy.resource() == std::pmr::get_default_resource());
+    ctest::assert_equal(copy.items(), list.items());
+}
+
+void benchmark_linked_list()
+{
+    // insertion heavy work, with a steady trickle of removals from the front
+    const int num_items{1000000};
+    LinkedList<long> list{};
+    const double seconds{ctest::time_it([&list]()
+                                        { for (long i = 0; i < num_items; ++i)
+                                          {
+                                              list.add(i);
+                                              if (i % 4 == 0)
+                                                  list.pop_left();
+                                          } })};
+    ctest::assert_equal(list.size(), num_items - num_items / 4);
+    std::cout << "ns per add: " << seconds * 1e9 / num_items << std::endl;
+}
+
 int main()
 {
     test_linked_list_add();
@@ -131,4 +386,13 @@ int main()
     test_linked_list_reverse();
     test_linked_list_ends();
     test_linked_list_end_manipulation();
+    test_linked_list_tracked_nodes();
+    test_linked_list_copy();
+    test_linked_list_clear();
+    test_linked_list_splice();
+    test_linked_list_splice_range();
+    test_linked_list_shared_pool();
+    test_linked_list_merge();
+    test_linked_list_memory_resource();
+    benchmark_linked_list();
 }
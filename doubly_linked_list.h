@@ -2,7 +2,12 @@
 #define CPP_LEARNING_DOUBLY_LINKED_LIST
 
 #include <memory>
+#include <memory_resource>
 #include <optional>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <assert.h>
 #include "itertools.h"
 
 template <typename T>
@@ -11,62 +16,204 @@ class DoubleNode
 public:
     DoubleNode(const T item = T{})
         : item{item},
-          next_node{std::shared_ptr<DoubleNode<T>>{nullptr}},
-          prev_node{std::weak_ptr<DoubleNode<T>>{}} {}
+          next_node{nullptr},
+          prev_node{nullptr} {}
 
     void swap_order()
     {
-        std::shared_ptr<DoubleNode<T>> temp_prev_node{prev_node.lock()};
-        prev_node = next_node;
-        next_node = temp_prev_node;
+        std::swap(prev_node, next_node);
     }
 
     T item;
-    std::shared_ptr<DoubleNode<T>> next_node;
-    // weak_ptr to avoid shared_ptr cycles, so the DoublyLinkedList can be deallocated after going out of scope
-    std::weak_ptr<DoubleNode<T>> prev_node;
+    // the nodes are owned by the list's NodePool, so the links don't need to own anything
+    DoubleNode<T> *next_node;
+    DoubleNode<T> *prev_node;
 };
 
+namespace doubly_linked_list
+{
+    // size of the first slab a pool allocates, each following slab is twice as big up to the max
+    constexpr size_t FIRST_SLAB_SIZE{8};
+    constexpr size_t MAX_SLAB_SIZE{4096};
+}
+
+// Allocates nodes from slabs (arrays of nodes) instead of one heap allocation per node
+// Released nodes go on a free list threaded through their next_node links, and are handed out again before the slabs grow
+// Slabs are never moved or freed until the pool is destroyed, so node pointers stay valid, even when the pool is moved
+// The slabs come from the given memory resource
+template <typename T>
+class NodePool
+{
+public:
+    explicit NodePool(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : memory{resource}, slabs{}, slab_used{0}, next_slab_size{doubly_linked_list::FIRST_SLAB_SIZE}, free_list{nullptr} {}
+
+    NodePool(const NodePool &other) = delete;
+    NodePool &operator=(const NodePool &other) = delete;
+
+    NodePool(NodePool &&other) : NodePool(other.resource()) { other.swap(*this); }
+
+    NodePool &operator=(NodePool &&other)
+    {
+        NodePool(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~NodePool()
+    {
+        std::pmr::polymorphic_allocator<DoubleNode<T>> allocator{resource()};
+        for (const Slab &slab : slabs)
+        {
+            std::destroy_n(slab.nodes, slab.size);
+            allocator.deallocate(slab.nodes, slab.size);
+        }
+    }
+
+    DoubleNode<T> *allocate(const T &item)
+    {
+        DoubleNode<T> *node{free_list};
+        if (node)
+            free_list = node->next_node;
+        else
+        {
+            if (slabs.empty() || slab_used == slabs.back().size)
+                add_slab();
+            node = &slabs.back().nodes[slab_used++];
+        }
+        node->item = item;
+        node->next_node = nullptr;
+        node->prev_node = nullptr;
+        return node;
+    }
+
+    // return a node to the pool, the node must have come from this pool
+    void release(DoubleNode<T> *node)
+    {
+        node->item = T{}; // drop anything the item owns now rather than when the node is reused
+        node->prev_node = nullptr;
+        node->next_node = free_list;
+        free_list = node;
+    }
+
+    // take ownership of all of other's slabs, so nodes allocated by other can be linked into and released to this pool
+    // O(number of slabs), no nodes are moved so pointers to them stay valid
+    // both pools must use the same memory resource
+    void adopt(NodePool &other)
+    {
+        assert(*resource() == *other.resource());
+        // the slabs go before the last slab, which is still being handed out
+        // other's free nodes and the unused end of its last slab aren't reused, they're freed with the slabs
+        slabs.insert((slabs.empty()) ? slabs.end() : slabs.end() - 1,
+                     other.slabs.begin(), other.slabs.end());
+        other.slabs.clear();
+        NodePool(other.resource()).swap(other);
+    }
+
+    std::pmr::memory_resource *resource() const { return memory; }
+
+    void swap(NodePool &other) noexcept
+    {
+        std::swap(this->memory, other.memory);
+        std::swap(this->slabs, other.slabs);
+        std::swap(this->slab_used, other.slab_used);
+        std::swap(this->next_slab_size, other.next_slab_size);
+        std::swap(this->free_list, other.free_list);
+    }
+
+private:
+    struct Slab
+    {
+        DoubleNode<T> *nodes;
+        size_t size;
+    };
+
+    std::pmr::memory_resource *memory;
+    std::vector<Slab> slabs; // only a few entries, so it stays on the default heap
+    size_t slab_used; // nodes handed out from the last slab
+    size_t next_slab_size;
+    DoubleNode<T> *free_list;
+
+    void add_slab()
+    {
+        std::pmr::polymorphic_allocator<DoubleNode<T>> allocator{resource()};
+        DoubleNode<T> *const nodes{allocator.allocate(next_slab_size)};
+        std::uninitialized_default_construct_n(nodes, next_slab_size);
+        slabs.push_back(Slab{nodes, next_slab_size});
+        slab_used = 0;
+        next_slab_size = std::min(2 * next_slab_size, doubly_linked_list::MAX_SLAB_SIZE);
+    }
+};
+
+// Nodes come from a NodePool, which lists can share so that nodes can be spliced and merged between them
+// The pool is freed with the last list using it
 template <typename T>
 class LinkedList
 {
 public:
     using value_type = T;
 
-    LinkedList() : length{0}
+    LinkedList() : LinkedList(std::pmr::get_default_resource()) {}
+
+    // allocate the nodes from resource, which must outlive the list
+    explicit LinkedList(std::pmr::memory_resource *resource)
+        : LinkedList(std::allocate_shared<NodePool<T>>(std::pmr::polymorphic_allocator<NodePool<T>>{resource}, resource)) {}
+
+    // allocate the nodes from a pool shared with other lists, see node_pool
+    explicit LinkedList(std::shared_ptr<NodePool<T>> node_pool) : pool{std::move(node_pool)}, length{0}
     {
-        head = std::make_shared<DoubleNode<T>>();
+        head = pool->allocate(T{});
         last = head;
     }
 
-    LinkedList(const std::initializer_list<T> &items) : LinkedList()
+    LinkedList(const std::initializer_list<T> &items, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : LinkedList(resource)
     {
         for (const T item : items)
             add(item);
     }
 
+    // copies get their own nodes, from the default resource like the std::pmr containers
+    LinkedList(const LinkedList &other) : LinkedList()
+    {
+        for (const DoubleNode<T> *current = other.head->next_node; current; current = current->next_node)
+            add(current->item);
+    }
+
+    // the nodes stay where they are, so pointers from add_and_track still refer to them in the moved to list
+    LinkedList(LinkedList &&other) : LinkedList(other.resource()) { other.swap(*this); }
+
+    LinkedList &operator=(const LinkedList &other)
+    {
+        LinkedList(other).swap(*this);
+        return *this;
+    }
+
+    LinkedList &operator=(LinkedList &&other)
+    {
+        LinkedList(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    // an unshared pool frees its slabs at once, a shared pool gets this list's nodes back for the other lists to use
+    ~LinkedList()
+    {
+        if (pool.use_count() > 1)
+            release_after(nullptr);
+    }
+
     // add item to the linked list, O(1)
     void add(const T item)
     {
-        // note: need to update head if this is the first item
-        // then update last to point to the new item
-        std::shared_ptr<DoubleNode<T>> new_node{std::make_shared<DoubleNode<T>>(item)};
-        if (length == 0)
-        {
-            head->next_node = new_node;
-            new_node->prev_node = head;
-        }
-        else
-        {
-            last->next_node = new_node;
-            new_node->prev_node = last;
-        }
+        DoubleNode<T> *new_node{pool->allocate(item)};
+        last->next_node = new_node;
+        new_node->prev_node = last;
         last = new_node;
         ++length;
     }
 
-    // add an item and return a shared_ptr to its node
-    std::shared_ptr<DoubleNode<T>> add_and_track(const T &item)
+    // add an item and return a pointer to its node
+    // the pointer stays valid until the node is removed or the list is destroyed
+    DoubleNode<T> *add_and_track(const T &item)
     {
         add(item);
         return last;
@@ -74,18 +221,15 @@ public:
 
     void add_left(const T item)
     {
-        std::shared_ptr<DoubleNode<T>> new_node{std::make_shared<DoubleNode<T>>(item)};
+        DoubleNode<T> *new_node{pool->allocate(item)};
         if (length == 0)
-        {
             last = new_node;
-            head->next_node = new_node;
-        }
         else
         {
             new_node->next_node = head->next_node;
             head->next_node->prev_node = new_node;
-            head->next_node = new_node;
         }
+        head->next_node = new_node;
         new_node->prev_node = head;
         ++length;
     }
@@ -113,15 +257,7 @@ public:
     void insert(const int index, const T item)
     {
         itertools::validate_index(index, length);
-        std::shared_ptr<DoubleNode<T>> prev_node{get_node(index - 1)};
-        std::shared_ptr<DoubleNode<T>> new_node{std::make_shared<DoubleNode<T>>(item)};
-        std::shared_ptr<DoubleNode<T>> next_node{prev_node->next_node};
-        prev_node->next_node = new_node;
-        new_node->next_node = next_node;
-
-        next_node->prev_node = new_node;
-        new_node->prev_node = prev_node;
-        ++length;
+        insert_after(get_node(index - 1), item);
     }
 
     // remove item anywhere in the list, O(n)
@@ -131,20 +267,128 @@ public:
         remove(get_node(index));
     }
 
-    // remove a node in this linkedlist
+    // remove a node in this linkedlist, the node is returned to the pool so it mustn't be used afterwards
     // note: doesn't check the node is contained in the linkedlist
-    void remove(const std::shared_ptr<DoubleNode<T>> &node)
+    void remove(DoubleNode<T> *node)
     {
-        std::shared_ptr<DoubleNode<T>> prev_node{node->prev_node};
-        std::shared_ptr<DoubleNode<T>> following_node{node->next_node};
+        DoubleNode<T> *prev_node{node->prev_node};
+        DoubleNode<T> *following_node{node->next_node};
         if (!following_node)
             last = prev_node; // removing the last item, so update it to point to prev_node
         else
             following_node->prev_node = prev_node;
         prev_node->next_node = following_node;
+        pool->release(node);
         --length;
     }
 
+    // remove all items, freeing the pool's slabs at once rather than releasing each node, unless the pool is shared
+    void clear()
+    {
+        if (pool.use_count() > 1)
+        {
+            release_after(head);
+            head->next_node = nullptr;
+            last = head;
+            length = 0;
+        }
+        else
+            LinkedList(resource()).swap(*this);
+    }
+
+    // move all of other's items onto the end of this list, leaving other empty, O(1) once the pools are joined
+    // the nodes are relinked, so pointers from other's add_and_track now refer to nodes in this list
+    // lists with separate pools from the same memory resource are joined to share one of them, in O(number of slabs)
+    // otherwise (different memory resources, or both pools already shared with other lists) the items are copied in O(n)
+    // and other's nodes are released, so pointers from its add_and_track are invalidated
+    void splice(LinkedList &other)
+    {
+        if (other.length == 0 || &other == this)
+            return;
+        if (join_pools(other))
+            relink_after(last, other, other.head->next_node, other.last, other.length);
+        else
+            copy_after(last, other, other.head->next_node, other.last);
+    }
+
+    // move all of other's items onto the start of this list, leaving other empty, with the same cost as splice
+    void splice_left(LinkedList &other)
+    {
+        if (other.length == 0 || &other == this)
+            return;
+        if (join_pools(other))
+            relink_after(head, other, other.head->next_node, other.last, other.length);
+        else
+            copy_after(head, other, other.head->next_node, other.last);
+    }
+
+    // move the items from first to last inclusive out of other, and insert them after pos
+    // pos is a node in this list, or before_begin() to insert at the start, and mustn't be one of the items moved
+    // O(1) within a list, or O(number of items moved) between lists to count them, like std::list::splice
+    // the pools are joined as for splice, and when they can't be the items are copied and their old nodes released
+    void splice(DoubleNode<T> *pos, LinkedList &other, DoubleNode<T> *first, DoubleNode<T> *last_moved)
+    {
+        if (!join_pools(other))
+        {
+            copy_after(pos, other, first, last_moved);
+            return;
+        }
+        int count{1};
+        if (&other != this)
+            for (const DoubleNode<T> *current = first; current != last_moved; current = current->next_node)
+                ++count;
+        relink_after(pos, other, first, last_moved, count);
+    }
+
+    // merge other's items into this list, both sorted by compare, leaving other empty
+    // equal items from this list stay before other's, O(n + m) relinking the nodes once the pools are joined
+    // when the pools can't be joined, other's items are copied first, as for splice
+    template <typename Compare = std::less<T>>
+    void merge(LinkedList &other, const Compare &compare = Compare{})
+    {
+        if (other.length == 0 || &other == this)
+            return;
+        if (!join_pools(other))
+        {
+            // a new list with an unshared pool from this list's resource can always be joined
+            LinkedList copied{resource()};
+            copied.copy_after(copied.head, other, other.head->next_node, other.last);
+            merge(copied, compare);
+            return;
+        }
+        DoubleNode<T> *current{head}; // the items up to current are merged
+        DoubleNode<T> *other_current{other.head->next_node};
+        while (other_current)
+        {
+            DoubleNode<T> *const following{current->next_node};
+            if (!following)
+            {
+                // the rest of other goes on the end
+                current->next_node = other_current;
+                other_current->prev_node = current;
+                last = other.last;
+                break;
+            }
+            if (compare(other_current->item, following->item))
+            {
+                DoubleNode<T> *const next_other{other_current->next_node};
+                current->next_node = other_current;
+                other_current->prev_node = current;
+                other_current->next_node = following;
+                following->prev_node = other_current;
+                other_current = next_other;
+            }
+            current = current->next_node;
+        }
+        length += other.length;
+        other.head->next_node = nullptr;
+        other.last = other.head;
+        other.length = 0;
+    }
+
+    // the node before the first item, for inserting at the start with splice
+    DoubleNode<T> *before_begin() const { return head; }
+
     std::optional<T> front() const
     {
         return (length > 0) ? std::make_optional<T>(head->next_node->item) : std::nullopt;
@@ -166,53 +410,152 @@ public:
     std::vector<T> items() const
     {
         std::vector<T> result{};
-        std::shared_ptr<DoubleNode<T>> current = head->next_node;
-        while (current)
-        {
+        result.reserve(length);
+        for (const DoubleNode<T> *current = head->next_node; current; current = current->next_node)
             result.push_back(current->item);
-            current = current->next_node;
-        }
         return result;
     }
 
+    // call func on every item in order, without copying them
+    template <typename Func>
+    void for_each(const Func &func) const
+    {
+        for (const DoubleNode<T> *current = head->next_node; current; current = current->next_node)
+            func(current->item);
+    }
+
     void reverse()
     {
         if (length <= 1)
             return;
 
-        std::shared_ptr<DoubleNode<T>> current{last};
-        while (current)
-        {
+        // swapping every node's links reverses the list, then the ends are reattached to head
+        DoubleNode<T> *const first{head->next_node};
+        for (DoubleNode<T> *current = first; current; current = current->prev_node)
             current->swap_order();
-            current = current->next_node;
-        }
-        std::swap(head, last);
-
-        // after swapping, tail will point to one past the last element, so remove that
-        std::shared_ptr<DoubleNode<T>> new_last{last->prev_node};
-        new_last->next_node = nullptr;
-        last = new_last;
-
-        // head needs to point to one before the first node
-        auto new_head = std::make_shared<DoubleNode<T>>();
-        new_head->next_node = head;
-        head->prev_node = new_head;
-        head = new_head;
+        head->next_node = last;
+        last->prev_node = head;
+        first->next_node = nullptr;
+        last = first;
     }
 
     int size() const { return length; }
 
-    operator bool() const { return length > 0; }
+    std::pmr::memory_resource *resource() const { return pool->resource(); }
+
+    // the pool this list allocates from, to construct other lists sharing it
+    std::shared_ptr<NodePool<T>> node_pool() const { return pool; }
+
+    explicit operator bool() const { return length > 0; }
+
+    void swap(LinkedList &other) noexcept
+    {
+        std::swap(this->pool, other.pool);
+        std::swap(this->head, other.head);
+        std::swap(this->last, other.last);
+        std::swap(this->length, other.length);
+    }
 
 private:
-    std::shared_ptr<DoubleNode<T>> head; // points to 1 node before the first item
-    std::shared_ptr<DoubleNode<T>> last; // points to the last item
+    std::shared_ptr<NodePool<T>> pool;
+    DoubleNode<T> *head; // points to 1 node before the first item
+    DoubleNode<T> *last; // points to the last item
     int length;
 
-    std::shared_ptr<DoubleNode<T>> get_node(const int index)
+    // make both lists use one pool, so nodes can be relinked between them
+    // an unshared pool hands its slabs over to the other list's pool, O(number of slabs), no nodes are moved
+    // returns false if the pools use different memory resources or are both shared with other lists
+    bool join_pools(LinkedList &other)
+    {
+        if (pool == other.pool)
+            return true;
+        if (*resource() != *other.resource())
+            return false;
+        if (other.pool.use_count() == 1)
+        {
+            pool->adopt(*other.pool);
+            other.pool = pool;
+        }
+        else if (pool.use_count() == 1)
+        {
+            other.pool->adopt(*pool);
+            pool = other.pool;
+        }
+        else
+            return false;
+        return true;
+    }
+
+    // unlink first to last_moved (count items) from other and link them in after pos, the lists must share a pool
+    void relink_after(DoubleNode<T> *pos, LinkedList &other, DoubleNode<T> *first, DoubleNode<T> *last_moved, const int count)
+    {
+        DoubleNode<T> *const before{first->prev_node};
+        DoubleNode<T> *const after{last_moved->next_node};
+        before->next_node = after;
+        if (after)
+            after->prev_node = before;
+        else
+            other.last = before;
+        other.length -= count;
+
+        DoubleNode<T> *const following{pos->next_node};
+        pos->next_node = first;
+        first->prev_node = pos;
+        last_moved->next_node = following;
+        if (following)
+            following->prev_node = last_moved;
+        else
+            last = last_moved;
+        length += count;
+    }
+
+    // copy the items from first to last_moved into new nodes after pos, and remove them from other
+    void copy_after(DoubleNode<T> *pos, LinkedList &other, DoubleNode<T> *first, DoubleNode<T> *last_moved)
+    {
+        DoubleNode<T> *current{first};
+        while (true)
+        {
+            DoubleNode<T> *const next_node{current->next_node};
+            const bool is_last{current == last_moved};
+            pos = insert_after(pos, current->item);
+            other.remove(current);
+            if (is_last)
+                break;
+            current = next_node;
+        }
+    }
+
+    DoubleNode<T> *insert_after(DoubleNode<T> *prev_node, const T &item)
+    {
+        DoubleNode<T> *new_node{pool->allocate(item)};
+        DoubleNode<T> *next_node{prev_node->next_node};
+        prev_node->next_node = new_node;
+        new_node->next_node = next_node;
+        if (next_node)
+            next_node->prev_node = new_node;
+        else
+            last = new_node;
+        new_node->prev_node = prev_node;
+        ++length;
+        return new_node;
+    }
+
+    // return the nodes after node to the pool, or every node including head if node is nullptr
+    void release_after(DoubleNode<T> *node)
+    {
+        DoubleNode<T> *current{(node) ? node->next_node : head};
+        while (current)
+        {
+            DoubleNode<T> *const next_node{current->next_node};
+            pool->release(current);
+            current = next_node;
+        }
+    }
+
+    DoubleNode<T> *get_node(const int index)
     {
         assert(index >= -1 && index < length);
-        std::shared_ptr<DoubleNode<T>> current = head;
+        DoubleNode<T> *current = head;
         for (int i = -1; i < index; ++i)
             current = current->next_node;
         return current;
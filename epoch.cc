@@ -0,0 +1,165 @@
+#include <assert.h>
+#include <vector>
+#include <array>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include "epoch.h"
+#include "ctest.h"
+
+// node that counts how many have been freed
+struct CountedNode
+{
+    static inline std::atomic<int> freed{0};
+
+    std::array<int, 8> values;
+
+    explicit CountedNode(const int value) { values.fill(value); }
+
+    ~CountedNode()
+    {
+        values.fill(-1);
+        ++freed;
+    }
+};
+
+// collect enough times for the epoch to advance past everything retired so far
+void collect_all()
+{
+    for (int i = 0; i < 3; ++i)
+        epoch::collect();
+}
+
+void test_epoch_guard()
+{
+    const int freed_before{CountedNode::freed};
+    {
+        epoch::Guard guard{};
+        CountedNode *node{new CountedNode(1)};
+        epoch::retire(node);
+        {
+            // guards are reentrant, and a guard stops even its own thread freeing what it could see
+            epoch::Guard inner{};
+            collect_all();
+        }
+        collect_all();
+        ctest::assert_equal(CountedNode::freed.load(), freed_before);
+        ctest::assert_equal(node->values[0], 1);
+    }
+    collect_all();
+    ctest::assert_equal(CountedNode::freed.load(), freed_before + 1);
+}
+
+void test_epoch_batches()
+{
+    // retiring outside of guards frees in batches without any explicit collect
+    const int freed_before{CountedNode::freed};
+    for (int i = 0; i < 10 * static_cast<int>(epoch::COLLECT_THRESHOLD); ++i)
+        epoch::retire(new CountedNode(i));
+    assert(CountedNode::freed - freed_before > 0);
+    collect_all();
+    ctest::assert_equal(CountedNode::freed - freed_before, 10 * static_cast<int>(epoch::COLLECT_THRESHOLD));
+}
+
+void test_epoch_stress()
+{
+    // readers check the current node is never freed under them, while writers keep replacing and retiring it
+    const int freed_before{CountedNode::freed};
+    const int replacements_per_writer{50000};
+    std::atomic<CountedNode *> current{new CountedNode(0)};
+    std::atomic<bool> writing{true};
+    std::atomic<int> writers_left{ctest::NUM_THREADS / 2};
+    ctest::run_threads([&](const int thread)
+                { if (thread % 2 == 0)
+                  {
+                      for (int i = 1; i <= replacements_per_writer; ++i)
+                      {
+                          epoch::Guard guard{};
+                          CountedNode *const old_node{current.exchange(new CountedNode(i))};
+                          epoch::retire(old_node);
+                      }
+                      if (--writers_left == 0)
+                          writing = false;
+                      return;
+                  }
+                  while (writing)
+                  {
+                      epoch::Guard guard{};
+                      const CountedNode *const node{current.load()};
+                      const int value{node->values[0]};
+                      assert(value >= 0);
+                      for (const int other : node->values)
+                          ctest::assert_equal(other, value);
+                  } });
+    collect_all();
+    ctest::assert_equal(CountedNode::freed - freed_before, (ctest::NUM_THREADS / 2) * replacements_per_writer);
+    delete current.load();
+}
+
+// Per node cost of walking a list while other threads do the same, compared to a list of shared_ptr nodes
+void benchmark_epoch()
+{
+    struct SharedNode
+    {
+        int item;
+        std::shared_ptr<SharedNode> next;
+    };
+    struct RawNode
+    {
+        int item;
+        RawNode *next;
+    };
+
+    const int num_nodes{1000};
+    const int walks_per_thread{2000};
+    std::shared_ptr<SharedNode> shared_head{};
+    RawNode *raw_head{nullptr};
+    for (int i = 0; i < num_nodes; ++i)
+    {
+        shared_head = std::make_shared<SharedNode>(SharedNode{i, shared_head});
+        raw_head = new RawNode{i, raw_head};
+    }
+
+    std::atomic<long> shared_total{0};
+    const double shared_seconds{ctest::time_it([&]()
+                                               { ctest::run_threads([&](const int)
+                                                             { long total{0};
+                                                               for (int walk = 0; walk < walks_per_thread; ++walk)
+                                                                   // copying each shared_ptr keeps its node alive, at the cost of two atomic operations
+                                                                   for (std::shared_ptr<SharedNode> node = shared_head; node; node = node->next)
+                                                                       total += node->item;
+                                                               shared_total += total; }); })};
+    std::atomic<long> raw_total{0};
+    const double epoch_seconds{ctest::time_it([&]()
+                                              { ctest::run_threads([&](const int)
+                                                            { long total{0};
+                                                              for (int walk = 0; walk < walks_per_thread; ++walk)
+                                                              {
+                                                                  epoch::Guard guard{};
+                                                                  for (const RawNode *node = raw_head; node; node = node->next)
+                                                                      total += node->item;
+                                                              }
+                                                              raw_total += total; }); })};
+    ctest::assert_equal(shared_total.load(), raw_total.load());
+    const double num_steps{static_cast<double>(ctest::NUM_THREADS) * walks_per_thread * num_nodes};
+    std::cout << "ns per node walked: shared_ptr " << shared_seconds * 1e9 / num_steps
+              << ", epoch guard " << epoch_seconds * 1e9 / num_steps << std::endl;
+
+    // free the shared list iteratively, so its destructors don't recurse
+    while (shared_head)
+        shared_head = std::move(shared_head->next);
+    while (raw_head)
+    {
+        RawNode *const next{raw_head->next};
+        delete raw_head;
+        raw_head = next;
+    }
+}
+
+int main()
+{
+    test_epoch_guard();
+    test_epoch_batches();
+    test_epoch_stress();
+    benchmark_epoch();
+}
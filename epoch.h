@@ -0,0 +1,170 @@
+#ifndef CPP_LEARNING_EPOCH
+#define CPP_LEARNING_EPOCH
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include "thread_registry.h"
+
+namespace epoch
+{
+    // a thread tries to free its retired nodes once it has retired this many since it last tried
+    constexpr size_t COLLECT_THRESHOLD{64};
+}
+
+namespace __epoch_utils
+{
+    struct Retired
+    {
+        void *pointer;
+        void (*deleter)(void *);
+        uint64_t epoch; // the global epoch when it was retired
+    };
+
+    struct EpochRecord
+    {
+        std::atomic<uint64_t> epoch{0}; // the epoch shifted left 1, with the lowest bit set while the thread is in a guard
+    };
+
+    // The global epoch, and every thread's announced epoch
+    // The global epoch only advances once every thread in a guard has seen the current one, so once it has advanced twice
+    // past a node's retire epoch, every guard that could have seen the node has ended
+    class EpochDomain
+    {
+    public:
+        static EpochDomain &instance()
+        {
+            static EpochDomain domain{};
+            return domain;
+        }
+
+        EpochRecord *acquire_record() { return registry.acquire(); }
+
+        void release_record(EpochRecord *record)
+        {
+            record->epoch.store(0, std::memory_order_release);
+            registry.release(record);
+        }
+
+        uint64_t current() const { return global_epoch.load(); }
+
+        // advance the global epoch if every thread in a guard has announced the current one
+        void try_advance()
+        {
+            uint64_t epoch{global_epoch.load()};
+            bool all_current{true};
+            registry.for_each([epoch, &all_current](const EpochRecord &record)
+                              {
+                                  const uint64_t announced{record.epoch.load()};
+                                  if ((announced & 1) && (announced >> 1) != epoch)
+                                      all_current = false; });
+            if (all_current)
+                global_epoch.compare_exchange_strong(epoch, epoch + 1);
+        }
+
+        // free the retired nodes that are at least 2 epochs old, the rest stay in retired
+        void collect(std::vector<Retired> &retired)
+        {
+            registry.adopt_orphans(retired);
+            try_advance();
+            const uint64_t epoch{global_epoch.load()};
+            size_t kept{0};
+            for (const Retired &item : retired)
+            {
+                if (item.epoch + 2 <= epoch)
+                    item.deleter(item.pointer);
+                else
+                    retired[kept++] = item;
+            }
+            retired.resize(kept);
+        }
+
+        // nodes from an exiting thread that weren't old enough to free
+        void orphan(const std::vector<Retired> &retired) { registry.orphan(retired); }
+
+    private:
+        std::atomic<uint64_t> global_epoch{0};
+        ThreadRegistry<EpochRecord, Retired> registry;
+    };
+
+    // A thread's announced epoch, how deeply it is nested in guards, and the nodes it has retired but not yet freed
+    struct ThreadState
+    {
+        EpochRecord *record;
+        int guards; // guards are reentrant, only the outermost one announces the epoch
+        std::vector<Retired> retired;
+        size_t retired_since_collect;
+
+        ThreadState() : record{EpochDomain::instance().acquire_record()}, guards{0}, retired{}, retired_since_collect{0} {}
+
+        // nodes too recent to free when the thread exits are left for another thread's collect
+        ~ThreadState()
+        {
+            EpochDomain &domain{EpochDomain::instance()};
+            domain.release_record(record);
+            domain.collect(retired);
+            if (!retired.empty())
+                domain.orphan(retired);
+        }
+    };
+
+    inline ThreadState &thread_state()
+    {
+        thread_local ThreadState state{};
+        return state;
+    }
+}
+
+namespace epoch
+{
+    // While a guard exists, nodes this thread can reach won't be freed, even if other threads retire them
+    // Guards should be short lived, as one held for a long time stops every thread's retired nodes being freed
+    class Guard
+    {
+    public:
+        Guard() : state{__epoch_utils::thread_state()}
+        {
+            if (state.guards++ == 0)
+                state.record->epoch.store((__epoch_utils::EpochDomain::instance().current() << 1) | 1);
+        }
+
+        Guard(const Guard &other) = delete;
+        Guard &operator=(const Guard &other) = delete;
+
+        ~Guard()
+        {
+            if (--state.guards == 0)
+                state.record->epoch.store(0, std::memory_order_release);
+        }
+
+    private:
+        __epoch_utils::ThreadState &state;
+    };
+
+    // Free node once every guard that could have seen it has ended. The node must already be unreachable
+    // Nodes are freed in batches, by whichever thread retired them
+    template <typename Node>
+    void retire(Node *node)
+    {
+        __epoch_utils::ThreadState &state{__epoch_utils::thread_state()};
+        __epoch_utils::EpochDomain &domain{__epoch_utils::EpochDomain::instance()};
+        state.retired.push_back(__epoch_utils::Retired{node, [](void *pointer)
+                                                       { delete static_cast<Node *>(pointer); },
+                                                       domain.current()});
+        // collecting inside a guard is safe, the guard stops the epoch advancing past anything it could have seen
+        if (++state.retired_since_collect >= COLLECT_THRESHOLD)
+        {
+            state.retired_since_collect = 0;
+            domain.collect(state.retired);
+        }
+    }
+
+    // try to advance the epoch and free this thread's retired nodes that are now safe to free
+    inline void collect()
+    {
+        __epoch_utils::ThreadState &state{__epoch_utils::thread_state()};
+        __epoch_utils::EpochDomain::instance().collect(state.retired);
+    }
+}
+
+#endif
@@ -107,11 +107,11 @@ namespace functools
     }
 
     // Find first item matching the predicate, if there is one
-    template <typename T, typename Pred>
-        requires std::predicate<Pred, T>
-    constexpr std::optional<T> find(const Pred &pred, const std::vector<T> &vec)
+    template <std::ranges::input_range Range, typename Pred>
+        requires std::predicate<Pred, std::ranges::range_value_t<Range>>
+    constexpr std::optional<std::ranges::range_value_t<Range>> find(const Pred &pred, const Range &range)
     {
-        for (const T &item : vec)
+        for (const auto &item : range)
             if (pred(item))
                 return std::make_optional(item);
         return std::nullopt;
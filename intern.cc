@@ -0,0 +1,112 @@
+#include <assert.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "intern.h"
+#include "strlib.h"
+#include "ctest.h"
+
+void test_intern()
+{
+    strlib::InternPool pool{};
+    const strlib::InternedString hello{pool.intern("hello")};
+    const strlib::InternedString there{pool.intern("there")};
+    ctest::assert_equal(hello.view(), "hello");
+    ctest::assert_equal(there.view(), "there");
+    assert(hello != there);
+    ctest::assert_equal(pool.size(), 2);
+
+    // interning the same text again gives the same string, wherever the text came from
+    const std::string hello_copy{"hello"};
+    const strlib::InternedString hello_again{pool.intern(hello_copy)};
+    assert(hello_again == hello);
+    ctest::assert_equal(hello_again.id(), hello.id());
+    ctest::assert_equal(hello_again.view().data(), hello.view().data());
+    ctest::assert_equal(pool.size(), 2);
+    ctest::assert_equal(pool.total_length(), 10);
+
+    ctest::assert_equal(pool[there.id()].view(), "there");
+    ctest::assert_outstream(there, "there");
+    ctest::assert_equal(strlib::format("{} {}", hello, there), "hello there");
+}
+
+void test_intern_find()
+{
+    strlib::InternPool pool{};
+    assert(!pool.find("missing"));
+    const strlib::InternedString word{pool.intern("word")};
+    ctest::assert_equal(pool.find("word"), word);
+    assert(!pool.find("wor"));
+    ctest::assert_equal(pool.size(), 1);
+}
+
+void test_intern_empty_and_long()
+{
+    strlib::InternPool pool{};
+    const strlib::InternedString empty{pool.intern("")};
+    ctest::assert_equal(empty.view(), "");
+    assert(pool.intern("") == empty);
+    ctest::assert_equal(strlib::InternedString().view(), "");
+    assert(strlib::InternedString() != empty);
+
+    const std::string long_text(3 * strlib::INTERN_POOL_BLOCK_SIZE, 'x');
+    const strlib::InternedString small{pool.intern("small")};
+    const strlib::InternedString long_string{pool.intern(long_text)};
+    const strlib::InternedString small2{pool.intern("small2")};
+    ctest::assert_equal(long_string.view(), long_text);
+    ctest::assert_equal(small.view(), "small");
+    ctest::assert_equal(small2.view(), "small2");
+    // a long string doesn't stop the current block being filled
+    ctest::assert_equal(small2.view().data(), small.view().data() + 5);
+}
+
+void test_intern_stable()
+{
+    // strings stay valid and keep their ids as the pool grows past many blocks and table resizes
+    strlib::InternPool pool{};
+    std::vector<strlib::InternedString> interned{};
+    for (int i = 0; i < 100000; ++i)
+        interned.push_back(pool.intern("string number " + strlib::to_str(i)));
+    ctest::assert_equal(pool.size(), 100000);
+
+    strlib::InternPool moved{std::move(pool)};
+    for (int i = 0; i < 100000; ++i)
+    {
+        const std::string expected{"string number " + strlib::to_str(i)};
+        ctest::assert_equal(interned[i].view(), expected);
+        ctest::assert_equal(interned[i].id(), i);
+        assert(moved.intern(expected) == interned[i]);
+    }
+    ctest::assert_equal(moved.size(), 100000);
+}
+
+void test_intern_moved_from()
+{
+    // a moved from pool is empty and can still be used
+    strlib::InternPool pool{};
+    const strlib::InternedString x{pool.intern("x")};
+    strlib::InternPool moved{std::move(pool)};
+    ctest::assert_equal(pool.size(), 0);
+    assert(!pool.find("x"));
+    const strlib::InternedString y{pool.intern("y")};
+    ctest::assert_equal(y.view(), "y");
+    ctest::assert_equal(pool.size(), 1);
+    ctest::assert_equal(moved.find("x"), x);
+
+    strlib::InternPool assigned{};
+    assigned.intern("z");
+    assigned = std::move(moved);
+    ctest::assert_equal(assigned.size(), 1);
+    ctest::assert_equal(assigned[x.id()].view(), "x");
+    ctest::assert_equal(moved.intern("w").view(), "w");
+    ctest::assert_equal(moved.size(), 1);
+}
+
+int main()
+{
+    test_intern();
+    test_intern_find();
+    test_intern_empty_and_long();
+    test_intern_stable();
+    test_intern_moved_from();
+}
@@ -0,0 +1,190 @@
+#ifndef STRLIB_INTERN
+#define STRLIB_INTERN
+
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace strlib
+{
+    // size of each block of characters the pool allocates, longer strings get a block to themselves
+    constexpr size_t INTERN_POOL_BLOCK_SIZE{1 << 16};
+
+    class InternPool;
+
+    // A string stored once in an InternPool
+    // Equal strings from the same pool have the same id, so hashing and comparing is just an integer operation
+    // Interned strings from different pools mustn't be compared, and they are only valid while their pool exists
+    class InternedString
+    {
+    public:
+        // an empty string that doesn't belong to any pool, so it is only equal to other default constructed strings
+        InternedString() : data{nullptr}, length{0}, string_id{std::numeric_limits<uint32_t>::max()} {}
+
+        uint32_t id() const { return string_id; }
+
+        std::string_view view() const { return std::string_view(data, length); }
+
+        operator std::string_view() const { return view(); }
+
+        friend bool operator==(const InternedString &left, const InternedString &right) { return left.string_id == right.string_id; }
+        friend bool operator!=(const InternedString &left, const InternedString &right) { return !(left == right); }
+
+        friend std::ostream &operator<<(std::ostream &os, const InternedString &str)
+        {
+            os << str.view();
+            return os;
+        }
+
+    private:
+        friend InternPool;
+
+        // the text is kept alongside the id so it can be read without going through the pool
+        const char *data;
+        uint32_t length;
+        uint32_t string_id;
+
+        InternedString(const std::string_view str, const uint32_t id)
+            : data{str.data()}, length{static_cast<uint32_t>(str.length())}, string_id{id} {}
+    };
+
+    // Stores one copy of each distinct string, giving out InternedStrings that refer to it
+    // Characters are copied into large blocks that are never moved or freed until the pool is destroyed,
+    // so interned strings stay valid as the pool grows, and each string costs its length plus a few bytes of index
+    class InternPool
+    {
+    public:
+        InternPool() : blocks{}, block_used{INTERN_POOL_BLOCK_SIZE}, strings{}, slots(16, EMPTY_SLOT), bytes{0} {}
+
+        // interned strings point into the pool, so a copy would give out strings that compare equal but point elsewhere
+        InternPool(const InternPool &other) = delete;
+        InternPool &operator=(const InternPool &other) = delete;
+
+        // moving keeps the blocks where they are, so existing interned strings stay valid
+        // the moved from pool is left empty and can still be used
+        InternPool(InternPool &&other) : InternPool() { other.swap(*this); }
+
+        InternPool &operator=(InternPool &&other)
+        {
+            InternPool(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        // Get the interned copy of str, adding it to the pool if it isn't there yet
+        InternedString intern(const std::string_view str)
+        {
+            size_t slot{find_slot(str)};
+            if (slots[slot] != EMPTY_SLOT)
+                return InternedString(strings[slots[slot]], slots[slot]);
+
+            if (strings.size() == std::numeric_limits<uint32_t>::max())
+                throw std::length_error("the intern pool is full");
+            if (str.length() > std::numeric_limits<uint32_t>::max())
+                throw std::length_error("string is too long to intern");
+            const uint32_t id(strings.size());
+            strings.push_back(copy_to_arena(str));
+            slots[slot] = id;
+            // keep the table at most half full so probe sequences stay short
+            if (2 * strings.size() > slots.size())
+                grow();
+            return InternedString(strings[id], id);
+        }
+
+        // Get the interned copy of str without adding it
+        std::optional<InternedString> find(const std::string_view str) const
+        {
+            const uint32_t id{slots[find_slot(str)]};
+            if (id == EMPTY_SLOT)
+                return std::nullopt;
+            return InternedString(strings[id], id);
+        }
+
+        // the interned string with this id
+        InternedString operator[](const uint32_t id) const { return InternedString(strings[id], id); }
+
+        // number of distinct strings in the pool
+        size_t size() const { return strings.size(); }
+
+        // total length of the distinct strings in the pool
+        size_t total_length() const { return bytes; }
+
+        void swap(InternPool &other) noexcept
+        {
+            std::swap(this->blocks, other.blocks);
+            std::swap(this->block_used, other.block_used);
+            std::swap(this->strings, other.strings);
+            std::swap(this->slots, other.slots);
+            std::swap(this->bytes, other.bytes);
+        }
+
+    private:
+        static constexpr uint32_t EMPTY_SLOT{std::numeric_limits<uint32_t>::max()};
+
+        std::vector<std::unique_ptr<char[]>> blocks;
+        size_t block_used; // characters used in the last block
+        std::vector<std::string_view> strings; // strings[id] is the text of that id
+        std::vector<uint32_t> slots;           // open addressing table of ids, its size is always a power of 2
+        size_t bytes;
+
+        // the slot holding str, or the empty slot it would be inserted at
+        size_t find_slot(const std::string_view str) const
+        {
+            const size_t mask{slots.size() - 1};
+            size_t slot{std::hash<std::string_view>{}(str) & mask};
+            while (slots[slot] != EMPTY_SLOT && strings[slots[slot]] != str)
+                slot = (slot + 1) & mask;
+            return slot;
+        }
+
+        void grow()
+        {
+            std::vector<uint32_t> old_slots(2 * slots.size(), EMPTY_SLOT);
+            std::swap(slots, old_slots);
+            for (const uint32_t id : old_slots)
+                if (id != EMPTY_SLOT)
+                    slots[find_slot(strings[id])] = id;
+        }
+
+        std::string_view copy_to_arena(const std::string_view str)
+        {
+            bytes += str.length();
+            if (str.empty())
+                return std::string_view{};
+            if (str.length() > INTERN_POOL_BLOCK_SIZE / 4)
+            {
+                // big strings would waste most of a shared block, so give them their own
+                // insert it before the current block so the current block can keep being filled
+                std::unique_ptr<char[]> own_block{new char[str.length()]};
+                std::memcpy(own_block.get(), str.data(), str.length());
+                const std::string_view copied{own_block.get(), str.length()};
+                blocks.insert((blocks.empty()) ? blocks.end() : blocks.end() - 1, std::move(own_block));
+                return copied;
+            }
+            if (block_used + str.length() > INTERN_POOL_BLOCK_SIZE)
+            {
+                blocks.emplace_back(new char[INTERN_POOL_BLOCK_SIZE]);
+                block_used = 0;
+            }
+            char *destination{blocks.back().get() + block_used};
+            std::memcpy(destination, str.data(), str.length());
+            block_used += str.length();
+            return std::string_view(destination, str.length());
+        }
+    };
+}
+
+// interned strings hash by id, ids are handed out consecutively so they spread evenly over a hash table's buckets
+template <>
+struct std::hash<strlib::InternedString>
+{
+    size_t operator()(const strlib::InternedString &str) const noexcept { return str.id(); }
+};
+
+#endif
@@ -6,6 +6,8 @@
 #include <iostream>
 #include <exception>
 #include <chrono>
+#include <array>
+#include <span>
 #include "itertools.h"
 #include "ctest.h"
 
@@ -97,18 +99,21 @@ void test_join()
 
 void test_chain_class()
 {
-    static_assert(std::ranges::input_range<__itertools_utils::Chain<int>>);
+    typedef __itertools_utils::Chain<std::ranges::ref_view<std::vector<int>>, std::ranges::ref_view<std::list<int>>> VecListChain;
+    static_assert(std::ranges::input_range<VecListChain>);
+    static_assert(std::input_iterator<VecListChain::iterator>);
+
     std::vector<int> vec1{1, 2};
-    std::vector<int> vec2{3, 4, 5};
-    __itertools_utils::Chain<int> chain(vec1, vec2);
-    __itertools_utils::Chain<int>::ChainIterator iter{chain.begin()};
+    std::list<int> list1{3, 4, 5};
+    VecListChain chain(std::views::all(vec1), std::views::all(list1));
+    VecListChain::ChainIterator iter{chain.begin()};
     ctest::assert_equal(*iter, 1);
     ctest::assert_equal(*++iter, 2);
     ctest::assert_equal(*++iter, 3);
     ctest::assert_equal(*++iter, 4);
     ctest::assert_equal(*++iter, 5);
     ++iter;
-    __itertools_utils::Chain<int>::ChainIterator end{chain.end()};
+    VecListChain::ChainIterator end{chain.end()};
     ctest::assert_equal(iter, end);
     std::vector<int> extracted(chain.begin(), chain.end());
     ctest::assert_equal(extracted, std::vector<int>{1, 2, 3, 4, 5});
@@ -126,6 +131,7 @@ void test_chain()
     std::vector<int> combined2(itertools::to_vec(itertools::chain(combined, list1)));
     ctest::assert_equal(combined2, itertools::range(1, 9));
 
+    // temporaries are moved into the chain, so they live as long as it does
     std::vector<int> combined3(
         itertools::to_vec(
             itertools::chain(
@@ -135,14 +141,23 @@ void test_chain()
                 std::vector<int>{7, 8})));
     ctest::assert_equal(combined3, itertools::range(1, 9));
 
+    // empty ranges are skipped over, wherever they are in the chain
+    std::vector<int> empty{};
+    ctest::assert_equal(itertools::to_vec(itertools::chain(empty, vec2, empty, empty, list1, empty)), std::vector<int>{3, 4, 5, 6, 7, 8});
+    ctest::assert_equal(itertools::to_vec(itertools::chain(empty, empty)), std::vector<int>{});
+    ctest::assert_equal(itertools::to_vec(itertools::chain(vec2)), vec2);
+
     // benchmark
     std::chrono::time_point start{std::chrono::system_clock::now()};
     std::vector<int> range1{itertools::range(1, 100000)};
     std::vector<int> range2{itertools::range(-100000, 0)};
     std::vector<int> range3{itertools::range(-100000, 100000)};
+    long total{0};
     for (const int i : itertools::range(1, 10))
-        itertools::chain(range1, range2, range3);
+        for (const int item : itertools::chain(range1, range2, range3))
+            total += item;
     std::chrono::time_point end{std::chrono::system_clock::now()};
+    ctest::assert_equal(total, 9 * (-100000L - 100000L)); // range1 and range2 cancel out except for -100000
 
     std::chrono::duration<double> elapsed_seconds = end - start;
     std::cout << "time taken: " << elapsed_seconds.count() << std::endl;
@@ -176,6 +191,90 @@ void test_generic_iterator()
     // Check that it can be used by other functions
     ctest::assert_equal(std::distance(begin, end), 0);
     static_assert(std::input_iterator<__itertools_utils::GenericIterator<int>>);
+
+    // Check moves and assignment transfer the iterator
+    __itertools_utils::GenericIterator<int> moved(std::move(orig));
+    ctest::assert_equal(*moved, 2);
+    copy = moved;
+    ctest::assert_equal(*copy, 2);
+    moved = __itertools_utils::GenericIterator<int>(vec.begin());
+    ctest::assert_equal(*moved, 1);
+
+    // iterators of different types are never equal
+    const std::vector<int> &const_vec{vec};
+    assert(__itertools_utils::GenericIterator<int>(vec.begin()) != __itertools_utils::GenericIterator<int>(const_vec.begin()));
+    ctest::assert_equal(__itertools_utils::GenericIterator<int>(), __itertools_utils::GenericIterator<int>());
+}
+
+// An iterator too large to be stored inline by GenericIterator
+struct LargeIterator
+{
+    typedef int value_type;
+    typedef std::ptrdiff_t difference_type;
+
+    std::vector<int>::const_iterator iter;
+    std::array<long, 8> padding{};
+
+    const int &operator*() const { return *iter; }
+    LargeIterator &operator++()
+    {
+        ++iter;
+        return *this;
+    }
+    friend bool operator==(const LargeIterator &iter1, const LargeIterator &iter2) { return iter1.iter == iter2.iter; }
+};
+
+void test_generic_iterator_storage()
+{
+    static_assert(__itertools_utils::GenericIterator<int>::fits_inline<int *>);
+    static_assert(__itertools_utils::GenericIterator<int>::fits_inline<std::vector<int>::iterator>);
+    static_assert(__itertools_utils::GenericIterator<int>::fits_inline<std::list<int>::const_iterator>);
+    static_assert(!__itertools_utils::GenericIterator<int>::fits_inline<LargeIterator>);
+
+    std::vector<int> vec{1, 2, 3};
+    __itertools_utils::GenericIterator<int> small{vec.begin()};
+    assert(small.is_inline());
+    __itertools_utils::GenericIterator<int> small_copy(small);
+    assert(small_copy.is_inline());
+
+    // large iterators fall back to the heap, but behave the same
+    __itertools_utils::GenericIterator<int> large{LargeIterator{vec.cbegin()}};
+    __itertools_utils::GenericIterator<int> large_end{LargeIterator{vec.cend()}};
+    assert(!large.is_inline());
+    __itertools_utils::GenericIterator<int> large_copy(large);
+    ++large;
+    ctest::assert_equal(*large, 2);
+    ctest::assert_equal(*large_copy, 1);
+    __itertools_utils::GenericIterator<int> large_moved(std::move(large_copy));
+    ctest::assert_equal(std::distance(large_moved, large_end), 3);
+}
+
+// Per element cost of iterating through a GenericRange, compared to iterating the range directly
+template <std::ranges::input_range Range>
+void benchmark_generic_range(const std::string &name, const Range &range)
+{
+    const int repeats{10};
+    long direct_total{0};
+    long erased_total{0};
+    const double direct_seconds{ctest::time_it([&range, &direct_total]()
+                                               { for (const int item : range) direct_total += item; },
+                                               repeats)};
+    const double erased_seconds{ctest::time_it([&range, &erased_total]()
+                                               { for (const int item : __itertools_utils::GenericRange<int>(range)) erased_total += item; },
+                                               repeats)};
+    ctest::assert_equal(direct_total, erased_total);
+
+    const double elements(std::distance(range.begin(), range.end()));
+    std::cout << name << " ns per element: direct " << direct_seconds * 1e9 / elements
+              << ", type erased " << erased_seconds * 1e9 / elements << std::endl;
+}
+
+void benchmark_generic_iterator()
+{
+    std::vector<int> vec{itertools::range(0, 1000000)};
+    std::list<int> list(vec.begin(), vec.end());
+    benchmark_generic_range("std::vector<int>", vec);
+    benchmark_generic_range("std::list<int>", list);
 }
 
 void test_generic_range()
@@ -191,6 +290,75 @@ void test_generic_range()
     static_assert(std::ranges::input_range<__itertools_utils::GenericRange<int>>);
 }
 
+// collect the spans of a span view into vectors, so they can be compared
+template <typename View>
+std::vector<std::vector<int>> collect_spans(const View &view)
+{
+    std::vector<std::vector<int>> result{};
+    for (const auto span : view)
+        result.emplace_back(span.begin(), span.end());
+    return result;
+}
+
+void test_chunked()
+{
+    std::vector<int> test_vec{1, 2, 3, 4, 5, 6, 7};
+    ctest::assert_equal(collect_spans(itertools::chunked(test_vec, 3)), std::vector<std::vector<int>>{{1, 2, 3}, {4, 5, 6}, {7}});
+    ctest::assert_equal(collect_spans(itertools::chunked(test_vec, 7)), std::vector<std::vector<int>>{{1, 2, 3, 4, 5, 6, 7}});
+    ctest::assert_equal(collect_spans(itertools::chunked(test_vec, 10)), std::vector<std::vector<int>>{{1, 2, 3, 4, 5, 6, 7}});
+    ctest::assert_equal(collect_spans(itertools::chunked(std::vector<int>{}, 2)), std::vector<std::vector<int>>{});
+    ctest::assert_equal(itertools::chunked(test_vec, 3).size(), 3);
+
+    // spans point into the original buffer instead of copying it
+    ctest::assert_equal((*itertools::chunked(test_vec, 3).begin()).data(), test_vec.data());
+    static_assert(std::ranges::forward_range<__itertools_utils::SpanView<int>>);
+
+    ctest::raises<std::invalid_argument>([&test_vec]()
+                                         { itertools::chunked(test_vec, 0); });
+}
+
+void test_windowed()
+{
+    std::vector<int> test_vec{1, 2, 3, 4};
+    ctest::assert_equal(collect_spans(itertools::windowed(test_vec, 2)), std::vector<std::vector<int>>{{1, 2}, {2, 3}, {3, 4}});
+    ctest::assert_equal(collect_spans(itertools::windowed(test_vec, 4)), std::vector<std::vector<int>>{{1, 2, 3, 4}});
+    ctest::assert_equal(collect_spans(itertools::windowed(test_vec, 5)), std::vector<std::vector<int>>{});
+    ctest::assert_equal(itertools::windowed(test_vec, 3).size(), 2);
+}
+
+void test_batched()
+{
+    std::array<int, 10> test_array{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    auto batches{itertools::batched<4>(test_array)};
+    static_assert(std::same_as<std::ranges::range_value_t<decltype(batches)>, std::span<const int, 4>>);
+    ctest::assert_equal(collect_spans(batches), std::vector<std::vector<int>>{{0, 1, 2, 3}, {4, 5, 6, 7}});
+    ctest::assert_equal(std::vector<int>(batches.remainder().begin(), batches.remainder().end()), std::vector<int>{8, 9});
+
+    std::vector<int> exact{1, 2, 3, 4};
+    ctest::assert_equal(itertools::batched<2>(exact).size(), 2);
+    assert(itertools::batched<2>(exact).remainder().empty());
+    ctest::assert_equal(itertools::batched<8>(exact).remainder().size(), 4);
+}
+
+void test_strided()
+{
+    std::vector<int> test_vec{itertools::range(0, 10)};
+    ctest::assert_equal(itertools::to_vec(itertools::strided(test_vec, 3)), std::vector<int>{0, 3, 6, 9});
+    ctest::assert_equal(itertools::to_vec(itertools::strided(test_vec, 1)), test_vec);
+    ctest::assert_equal(itertools::to_vec(itertools::strided(test_vec, 20)), std::vector<int>{0});
+    ctest::assert_equal(itertools::strided(test_vec, 4).size(), 3);
+    static_assert(std::ranges::forward_range<__itertools_utils::StridedView<int>>);
+}
+
+void test_prefetch()
+{
+    std::vector<int> test_vec{itertools::range(0, 1000)};
+    ctest::assert_equal(itertools::to_vec(itertools::prefetch(test_vec)), test_vec);
+    ctest::assert_equal(itertools::to_vec(itertools::prefetch(test_vec, 5000)), test_vec);
+    ctest::assert_equal(itertools::to_vec(itertools::prefetch(std::vector<int>{}, 8)), std::vector<int>{});
+    static_assert(std::ranges::forward_range<__itertools_utils::PrefetchView<int>>);
+}
+
 int main()
 {
     test_slice();
@@ -206,6 +374,13 @@ int main()
     test_chain();
     test_generic_iterator();
     test_generic_range();
+    test_generic_iterator_storage();
+    benchmark_generic_iterator();
+    test_chunked();
+    test_windowed();
+    test_batched();
+    test_strided();
+    test_prefetch();
 
     // test if the templating works for strings as well
     std::vector<int> int_vec{1, 2, 3, 4, 5};
@@ -10,6 +10,10 @@
 #include <optional>
 #include <assert.h>
 #include <ranges>
+#include <memory>
+#include <span>
+#include <array>
+#include <variant>
 #include "math.h"
 #include "strlib.h"
 #include "slice.h"
@@ -18,6 +22,8 @@ namespace __itertools_utils
 {
     // Type erasure class that holds any iterator, satisfying an input_iterator
     // type erasure reference: https://www.modernescpp.com/index.php/type-erasure/
+    // Small iterators (pointers, vector/list iterators, LinkedList iterators) are stored in an inline buffer,
+    // so only unusually large iterators need a heap allocation
     template <typename T>
     class GenericIterator
     {
@@ -28,44 +34,60 @@ namespace __itertools_utils
         typedef std::ptrdiff_t difference_type;
         typedef std::input_iterator_tag iterator_category;
 
+        // size of the inline buffer, enough for the model's vtable pointer and type tag, plus an iterator of two pointers
+        static constexpr size_t INLINE_SIZE{4 * sizeof(void *)};
+
         GenericIterator() : iter_ptr{nullptr} {};
 
         // Implement copy constructors that deep copy the iterator, so we can call .begin() multiple times
         // Also implement move constructors to follow the rule of 5
-        GenericIterator(const GenericIterator &other) : iter_ptr{other.clone()} {};
+        GenericIterator(const GenericIterator &other) : iter_ptr{(other.iter_ptr) ? other.iter_ptr->clone(buffer) : nullptr} {};
 
         GenericIterator &operator=(const GenericIterator &other)
         {
-            GenericIterator(other).swap(*this);
+            if (this != &other)
+            {
+                reset();
+                iter_ptr = (other.iter_ptr) ? other.iter_ptr->clone(buffer) : nullptr;
+            }
             return *this;
         }
 
-        GenericIterator(GenericIterator &&other)
-        {
-            other.swap(*this);
-            other.iter_ptr = nullptr;
-        }
+        GenericIterator(GenericIterator &&other) : iter_ptr{nullptr} { take(other); }
 
         GenericIterator &operator=(GenericIterator &&other)
         {
-            GenericIterator(std::move(other)).swap(*this);
+            if (this != &other)
+            {
+                reset();
+                take(other);
+            }
             return *this;
         }
 
+        ~GenericIterator() { reset(); }
+
         // note: should have concepts like this: template <std::input_iterator Iter>  requires std::same_as<std::iter_value_t<Iter>, T>
         // but this doesn't work, because then determining whether GenericIterator itself satisfies std::input_iterator causes a recursion
         template <typename Iter>
-        GenericIterator(const Iter &iter) : iter_ptr{std::make_unique<IteratorModel<Iter>>(iter)} {};
+        GenericIterator(const Iter &iter) : iter_ptr{make_model(iter, buffer)} {};
 
         // The abstract interface for an iterator
+        // type_tag identifies the concrete IteratorModel, so equality can be checked without a dynamic_cast
         struct IteratorConcept
         {
+            IteratorConcept(const void *type_tag) : type_tag{type_tag} {}
             virtual ~IteratorConcept(){};
             virtual reference operator*() const = 0;
             virtual IteratorConcept &operator++() = 0;
-            virtual std::unique_ptr<IteratorConcept> clone() const = 0;
-            virtual bool operator==(const IteratorConcept &) const = 0;
-            virtual bool operator!=(const IteratorConcept &) const = 0;
+            // copy into buffer if the model fits inline, otherwise onto the heap
+            virtual IteratorConcept *clone(std::byte *buffer) const = 0;
+            // move an inline model into another buffer
+            virtual IteratorConcept *move_to(std::byte *buffer) = 0;
+            // compare with a model that has the same type_tag
+            virtual bool equals(const IteratorConcept &) const = 0;
+
+            const void *const type_tag;
         };
 
         // Take any iterator, and make a class for it that inherits from the abstract interface
@@ -73,25 +95,32 @@ namespace __itertools_utils
         struct IteratorModel : IteratorConcept
         {
         public:
-            IteratorModel(const Iter iter) : iter{iter} {}
+            IteratorModel(const Iter iter) : IteratorConcept{&tag}, iter{iter} {}
             reference operator*() const override { return *iter; }
             IteratorModel &operator++() override
             {
                 ++iter;
                 return *this;
             }
-            std::unique_ptr<IteratorConcept> clone() const override { return std::make_unique<IteratorModel<Iter>>(*this); };
-            virtual bool operator==(const IteratorConcept &other) const override
+            IteratorConcept *clone(std::byte *buffer) const override { return make_model(iter, buffer); }
+            IteratorConcept *move_to(std::byte *buffer) override { return new (buffer) IteratorModel<Iter>(std::move(iter)); }
+            bool equals(const IteratorConcept &other) const override
             {
-                auto other_ptr{dynamic_cast<const IteratorModel *>(&other)};
-                return other_ptr != 0 && iter == other_ptr->iter;
+                return iter == static_cast<const IteratorModel &>(other).iter;
             }
-            virtual bool operator!=(const IteratorConcept &other) const override { return !(*this == other); }
 
         private:
+            // only the address matters, it is unique for each Iter
+            static constexpr char tag{};
             Iter iter;
         };
 
+        // whether the model for Iter is stored in the inline buffer
+        template <typename Iter>
+        static constexpr bool fits_inline{sizeof(IteratorModel<Iter>) <= INLINE_SIZE &&
+                                          alignof(IteratorModel<Iter>) <= alignof(std::max_align_t) &&
+                                          std::is_nothrow_move_constructible_v<Iter>};
+
         // Finally, using the pointer to the abstract IteratorModel, we can implement the iterator methods
         reference operator*() const { return *(*iter_ptr); }
         GenericIterator<T> &operator++()
@@ -105,14 +134,52 @@ namespace __itertools_utils
             ++*this;
             return temp;
         }
-        std::unique_ptr<IteratorConcept> clone() const { return iter_ptr->clone(); }
-        friend bool operator==(const GenericIterator &iter1, const GenericIterator &iter2) { return *iter1.iter_ptr == *iter2.iter_ptr; }
+        friend bool operator==(const GenericIterator &iter1, const GenericIterator &iter2)
+        {
+            if (!iter1.iter_ptr || !iter2.iter_ptr)
+                return iter1.iter_ptr == iter2.iter_ptr;
+            return iter1.iter_ptr->type_tag == iter2.iter_ptr->type_tag && iter1.iter_ptr->equals(*iter2.iter_ptr);
+        }
         friend bool operator!=(const GenericIterator &iter1, const GenericIterator &iter2) { return !(iter1 == iter2); }
 
+        bool is_inline() const { return iter_ptr && static_cast<const void *>(iter_ptr) == static_cast<const void *>(buffer); }
+
     private:
-        std::unique_ptr<IteratorConcept> iter_ptr;
+        IteratorConcept *iter_ptr; // points into buffer for inline models, otherwise owns a heap allocation
+        alignas(std::max_align_t) std::byte buffer[INLINE_SIZE];
+
+        template <typename Iter>
+        static IteratorConcept *make_model(const Iter &iter, std::byte *buffer)
+        {
+            if constexpr (fits_inline<Iter>)
+                return new (buffer) IteratorModel<Iter>(iter);
+            else
+                return new IteratorModel<Iter>(iter);
+        }
 
-        void swap(GenericIterator &other) noexcept { std::swap(this->iter_ptr, other.iter_ptr); }
+        // take the model of other, leaving other empty
+        void take(GenericIterator &other)
+        {
+            if (other.is_inline())
+            {
+                iter_ptr = other.iter_ptr->move_to(buffer);
+                other.reset();
+            }
+            else
+            {
+                iter_ptr = other.iter_ptr;
+                other.iter_ptr = nullptr;
+            }
+        }
+
+        void reset()
+        {
+            if (is_inline())
+                iter_ptr->~IteratorConcept();
+            else
+                delete iter_ptr;
+            iter_ptr = nullptr;
+        }
     };
 
     // Type erasure class that holds an Range and provides an input iterator over it
@@ -136,41 +203,39 @@ namespace __itertools_utils
         GenericIterator<T> end_iter;
     };
 
-    // Class that holds several ranges and provides an input iterator to go over all of them
-    template <typename T>
+    // Class that holds several ranges, of possibly different types, and provides an input iterator to go over all of them
+    // The iterator is a variant of the ranges' iterators, so iterating needs no heap allocation or virtual calls
+    template <std::ranges::view... Views>
+        requires(sizeof...(Views) > 0) && (std::ranges::common_range<const Views> && ...)
     class Chain
     {
     public:
+        static constexpr size_t num_ranges{sizeof...(Views)};
+
         struct ChainIterator
         {
         public:
-            typedef T value_type;
-            typedef const value_type *pointer;
-            typedef const value_type &reference;
+            typedef std::ranges::range_value_t<std::tuple_element_t<0, std::tuple<Views...>>> value_type;
+            typedef std::common_reference_t<std::ranges::range_reference_t<const Views>...> reference;
             typedef std::ptrdiff_t difference_type;
             typedef std::input_iterator_tag iterator_category;
 
-            ChainIterator() : current_chain{nullptr}, current_iter{nullptr}, current_end{nullptr} {}
+            ChainIterator() : chain{nullptr}, current{} {}
 
-            ChainIterator(const Chain<T> &chain) : current_chain{std::make_shared<Chain<T>>(chain)},
-                                                   current_iter{chain.range.begin()},
-                                                   current_end{chain.range.end()} {}
+            // Start at iter in the Idx'th range
+            template <size_t Idx>
+            ChainIterator(const Chain *chain, std::in_place_index_t<Idx> idx, const std::ranges::iterator_t<const std::tuple_element_t<Idx, std::tuple<Views...>>> &iter)
+                : chain{chain}, current{idx, iter} {}
 
-            // For initialising the end iterator
-            ChainIterator(const Chain<T> &chain, const GenericIterator<T> &iter) : current_chain{std::make_shared<Chain<T>>(chain)},
-                                                                                   current_iter{iter},
-                                                                                   current_end{iter} {}
-
-            reference operator*() const { return *current_iter; }
+            reference operator*() const
+            {
+                return std::visit([](const auto &iter) -> reference
+                                  { return *iter; },
+                                  current);
+            }
             ChainIterator &operator++()
             {
-                ++current_iter;
-                if (current_iter == current_end && current_chain->next_chain)
-                {
-                    current_chain = current_chain->next_chain;
-                    current_iter = current_chain->range.begin();
-                    current_end = current_chain->range.end();
-                }
+                increment<0>();
                 return *this;
             }
             ChainIterator operator++(int)
@@ -179,38 +244,264 @@ namespace __itertools_utils
                 ++*this;
                 return temp;
             }
-            friend bool operator==(const ChainIterator &iter1, const ChainIterator &iter2) { return iter1.current_iter == iter2.current_iter; }
+            friend bool operator==(const ChainIterator &iter1, const ChainIterator &iter2) { return iter1.current == iter2.current; }
             friend bool operator!=(const ChainIterator &iter1, const ChainIterator &iter2) { return !(iter1 == iter2); }
 
+            // move on to the following ranges while the current one is exhausted, stopping at the end of the last range
+            template <size_t Idx>
+            void skip_exhausted()
+            {
+                if constexpr (Idx + 1 < num_ranges)
+                {
+                    if (std::get<Idx>(current) == std::ranges::end(std::get<Idx>(chain->views)))
+                    {
+                        current.template emplace<Idx + 1>(std::ranges::begin(std::get<Idx + 1>(chain->views)));
+                        skip_exhausted<Idx + 1>();
+                    }
+                }
+            }
+
         private:
-            std::shared_ptr<Chain<T>> current_chain;
-            GenericIterator<T> current_iter;
-            GenericIterator<T> current_end;
+            const Chain *chain;
+            std::variant<std::ranges::iterator_t<const Views>...> current;
+
+            // find the range we are currently in at compile time, so the iterator type is known statically
+            template <size_t Idx>
+            void increment()
+            {
+                if (current.index() == Idx)
+                {
+                    ++std::get<Idx>(current);
+                    skip_exhausted<Idx>();
+                }
+                else if constexpr (Idx + 1 < num_ranges)
+                    increment<Idx + 1>();
+            }
         };
 
-        typedef T value_type;
+        typedef std::ranges::range_value_t<std::tuple_element_t<0, std::tuple<Views...>>> value_type;
         typedef ChainIterator iterator;
-        typedef const ChainIterator const_iterator;
+        typedef ChainIterator const_iterator;
 
-        template <std::ranges::input_range Range, std::ranges::input_range... Ranges>
-            requires std::same_as<std::iter_value_t<Range>, T>
-        Chain(const Range &range, const Ranges &...ranges) : range{GenericRange<T>(range)}, next_chain{nullptr}
+        constexpr Chain(Views... views) : views{std::move(views)...} {}
+
+        iterator begin() const
         {
-            if constexpr (sizeof...(ranges) > 0)
-                next_chain = std::make_shared<Chain<T>>(ranges...);
+            ChainIterator iter(this, std::in_place_index<0>, std::ranges::begin(std::get<0>(views)));
+            iter.template skip_exhausted<0>();
+            return iter;
         }
-
-        iterator begin() const { return ChainIterator(*this); }
         iterator end() const
         {
-            return (next_chain) ? next_chain->end() : ChainIterator(*this, range.end());
+            return ChainIterator(this, std::in_place_index<num_ranges - 1>, std::ranges::end(std::get<num_ranges - 1>(views)));
         }
         const_iterator cbegin() const { return begin(); }
         const_iterator cend() const { return end(); }
 
     private:
-        GenericRange<T> range;
-        std::shared_ptr<Chain<T>> next_chain;
+        std::tuple<Views...> views;
+    };
+
+    // Issue a software prefetch for the cache line holding addr, a no-op on compilers without the builtin
+    inline void prefetch(const void *addr)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(addr, 0, 3);
+#endif
+    }
+
+    // View over a contiguous buffer, yielding spans of `window` elements and advancing `step` elements each time
+    // If allow_partial is set the final span can be shorter than window, otherwise only full windows are yielded
+    // The spans point into the original buffer (nothing is copied), so the buffer must outlive the view
+    template <typename T, size_t Extent = std::dynamic_extent>
+    class SpanView
+    {
+    public:
+        typedef std::span<const T, Extent> value_type;
+
+        struct SpanIterator
+        {
+        public:
+            typedef std::span<const T, Extent> value_type;
+            typedef value_type reference;
+            typedef std::ptrdiff_t difference_type;
+            typedef std::forward_iterator_tag iterator_category;
+
+            SpanIterator() : data{nullptr}, offset{0}, limit{0}, length{0}, window{0}, step{0} {}
+
+            SpanIterator(const T *data, const size_t offset, const size_t limit, const size_t length, const size_t window, const size_t step)
+                : data{data}, offset{offset}, limit{limit}, length{length}, window{window}, step{step} {}
+
+            reference operator*() const { return value_type(data + offset, std::min(window, length - offset)); }
+            SpanIterator &operator++()
+            {
+                offset = std::min(offset + step, limit);
+                return *this;
+            }
+            SpanIterator operator++(int)
+            {
+                SpanIterator temp = *this;
+                ++*this;
+                return temp;
+            }
+            friend bool operator==(const SpanIterator &iter1, const SpanIterator &iter2) { return iter1.offset == iter2.offset; }
+            friend bool operator!=(const SpanIterator &iter1, const SpanIterator &iter2) { return !(iter1 == iter2); }
+
+        private:
+            const T *data;
+            size_t offset; // start of the current span
+            size_t limit;  // one past the last valid start offset, also the offset of the end iterator
+            size_t length;
+            size_t window;
+            size_t step;
+        };
+
+        typedef SpanIterator iterator;
+        typedef SpanIterator const_iterator;
+
+        SpanView(const T *data, const size_t length, const size_t window, const size_t step, const bool allow_partial)
+            : data{data},
+              length{length},
+              window{window},
+              step{step},
+              limit{(allow_partial) ? length : (length >= window) ? length - window + 1 : 0} {}
+
+        iterator begin() const { return SpanIterator(data, 0, limit, length, window, step); }
+        iterator end() const { return SpanIterator(data, limit, limit, length, window, step); }
+
+        // number of spans the view yields
+        size_t size() const { return (limit + step - 1) / step; }
+
+        // the trailing elements not covered by any span, e.g. the leftover elements after the last full batch
+        std::span<const T> remainder() const
+        {
+            const size_t covered{(size() == 0) ? 0 : std::min((size() - 1) * step + window, length)};
+            return std::span<const T>(data + covered, length - covered);
+        }
+
+    private:
+        const T *data;
+        size_t length;
+        size_t window;
+        size_t step;
+        size_t limit;
+    };
+
+    // View over every stride'th element of a contiguous buffer, starting with the first
+    template <typename T>
+    class StridedView
+    {
+    public:
+        typedef T value_type;
+
+        struct StridedIterator
+        {
+        public:
+            typedef T value_type;
+            typedef const value_type *pointer;
+            typedef const value_type &reference;
+            typedef std::ptrdiff_t difference_type;
+            typedef std::forward_iterator_tag iterator_category;
+
+            StridedIterator() : data{nullptr}, offset{0}, length{0}, stride{0} {}
+
+            StridedIterator(const T *data, const size_t offset, const size_t length, const size_t stride)
+                : data{data}, offset{offset}, length{length}, stride{stride} {}
+
+            reference operator*() const { return data[offset]; }
+            StridedIterator &operator++()
+            {
+                offset = std::min(offset + stride, length);
+                return *this;
+            }
+            StridedIterator operator++(int)
+            {
+                StridedIterator temp = *this;
+                ++*this;
+                return temp;
+            }
+            friend bool operator==(const StridedIterator &iter1, const StridedIterator &iter2) { return iter1.offset == iter2.offset; }
+            friend bool operator!=(const StridedIterator &iter1, const StridedIterator &iter2) { return !(iter1 == iter2); }
+
+        private:
+            const T *data;
+            size_t offset;
+            size_t length;
+            size_t stride;
+        };
+
+        typedef StridedIterator iterator;
+        typedef StridedIterator const_iterator;
+
+        StridedView(const T *data, const size_t length, const size_t stride) : data{data}, length{length}, stride{stride} {}
+
+        iterator begin() const { return StridedIterator(data, 0, length, stride); }
+        iterator end() const { return StridedIterator(data, length, length, stride); }
+        size_t size() const { return (length + stride - 1) / stride; }
+
+    private:
+        const T *data;
+        size_t length;
+        size_t stride;
+    };
+
+    // View over a contiguous buffer that prefetches the element `distance` places ahead on every step
+    template <typename T>
+    class PrefetchView
+    {
+    public:
+        typedef T value_type;
+
+        struct PrefetchIterator
+        {
+        public:
+            typedef T value_type;
+            typedef const value_type *pointer;
+            typedef const value_type &reference;
+            typedef std::ptrdiff_t difference_type;
+            typedef std::forward_iterator_tag iterator_category;
+
+            PrefetchIterator() : current{nullptr}, end{nullptr}, distance{0} {}
+
+            PrefetchIterator(const T *current, const T *end, const size_t distance) : current{current}, end{end}, distance{distance} {}
+
+            reference operator*() const { return *current; }
+            PrefetchIterator &operator++()
+            {
+                ++current;
+                // only prefetch inside the buffer, forming a pointer past its end is undefined
+                if (static_cast<size_t>(end - current) > distance)
+                    prefetch(current + distance);
+                return *this;
+            }
+            PrefetchIterator operator++(int)
+            {
+                PrefetchIterator temp = *this;
+                ++*this;
+                return temp;
+            }
+            friend bool operator==(const PrefetchIterator &iter1, const PrefetchIterator &iter2) { return iter1.current == iter2.current; }
+            friend bool operator!=(const PrefetchIterator &iter1, const PrefetchIterator &iter2) { return !(iter1 == iter2); }
+
+        private:
+            const T *current;
+            const T *end;
+            size_t distance;
+        };
+
+        typedef PrefetchIterator iterator;
+        typedef PrefetchIterator const_iterator;
+
+        PrefetchView(const T *data, const size_t length, const size_t distance) : data{data}, length{length}, distance{distance} {}
+
+        iterator begin() const { return PrefetchIterator(data, data + length, distance); }
+        iterator end() const { return PrefetchIterator(data + length, data + length, distance); }
+        size_t size() const { return length; }
+
+    private:
+        const T *data;
+        size_t length;
+        size_t distance;
     };
 }
 
@@ -228,7 +519,12 @@ namespace itertools
     constexpr void validate_index(const int &index, const int &length)
     {
         if (index < 0 || index >= length)
-            throw std::range_error(strlib::format("Invalid index {}, must be between 0 and {}", index, length));
+        {
+            // format into a stack buffer, two ints always fit so the message is never truncated
+            std::array<char, 64> message{};
+            strlib::format_to_n(message.data(), message.size() - 1, "Invalid index {}, must be between 0 and {}", index, length);
+            throw std::range_error(message.data());
+        }
     }
 
     template <std::ranges::bidirectional_range Range>
@@ -332,10 +628,61 @@ namespace itertools
     }
 
     // Chain any number of ranges together
-    template <std::ranges::input_range Range, std::ranges::input_range... Ranges>
-    constexpr __itertools_utils::Chain<std::iter_value_t<Range>> chain(const Range &range, const Ranges... ranges)
+    // lvalue ranges are referenced rather than copied, rvalue ranges are moved into the chain so it can outlive them
+    template <std::ranges::viewable_range Range, std::ranges::viewable_range... Ranges>
+        requires(std::same_as<range_t<Range>, range_t<Ranges>> && ...)
+    constexpr __itertools_utils::Chain<std::views::all_t<Range>, std::views::all_t<Ranges>...> chain(Range &&range, Ranges &&...ranges)
+    {
+        return __itertools_utils::Chain<std::views::all_t<Range>, std::views::all_t<Ranges>...>(
+            std::views::all(std::forward<Range>(range)), std::views::all(std::forward<Ranges>(ranges))...);
+    }
+
+    // Split a contiguous range into spans of size elements, the last span holds whatever is left over
+    // The spans refer to the original range, so no elements are copied
+    template <std::ranges::contiguous_range Range>
+        requires std::ranges::sized_range<Range>
+    constexpr __itertools_utils::SpanView<range_t<Range>> chunked(const Range &range, const size_t size)
+    {
+        if (size == 0)
+            throw std::invalid_argument("size cannot be 0");
+        return __itertools_utils::SpanView<range_t<Range>>(std::ranges::data(range), std::ranges::size(range), size, size, true);
+    }
+
+    // Sliding windows of size elements, advancing by one element at a time
+    // Ranges shorter than the window yield nothing
+    template <std::ranges::contiguous_range Range>
+        requires std::ranges::sized_range<Range>
+    constexpr __itertools_utils::SpanView<range_t<Range>> windowed(const Range &range, const size_t size)
+    {
+        if (size == 0)
+            throw std::invalid_argument("size cannot be 0");
+        return __itertools_utils::SpanView<range_t<Range>>(std::ranges::data(range), std::ranges::size(range), size, 1, false);
+    }
+    // Split a contiguous range into fixed size spans of Size elements, suitable for feeding fixed width kernels
+    // Unlike chunked, leftover elements don't form a batch, they can be retrieved with .remainder()
+    template <size_t Size, std::ranges::contiguous_range Range>
+        requires std::ranges::sized_range<Range> && (Size > 0)
+    constexpr __itertools_utils::SpanView<range_t<Range>, Size> batched(const Range &range)
+    {
+        return __itertools_utils::SpanView<range_t<Range>, Size>(std::ranges::data(range), std::ranges::size(range), Size, Size, false);
+    }
+
+    // Every stride'th element of a contiguous range, starting with the first
+    template <std::ranges::contiguous_range Range>
+        requires std::ranges::sized_range<Range>
+    constexpr __itertools_utils::StridedView<range_t<Range>> strided(const Range &range, const size_t stride)
+    {
+        if (stride == 0)
+            throw std::invalid_argument("stride cannot be 0");
+        return __itertools_utils::StridedView<range_t<Range>>(std::ranges::data(range), std::ranges::size(range), stride);
+    }
+
+    // Iterate a contiguous range, issuing a software prefetch for the element distance places ahead
+    template <std::ranges::contiguous_range Range>
+        requires std::ranges::sized_range<Range>
+    constexpr __itertools_utils::PrefetchView<range_t<Range>> prefetch(const Range &range, const size_t distance = 16)
     {
-        return __itertools_utils::Chain<std::iter_value_t<Range>>(range, ranges...);
+        return __itertools_utils::PrefetchView<range_t<Range>>(std::ranges::data(range), std::ranges::size(range), distance);
     }
 }
 
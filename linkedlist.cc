@@ -2,6 +2,7 @@
 #include <exception>
 #include <vector>
 #include <tuple>
+#include <functional>
 #include "itertools.h"
 #include "ctest.h"
 #include <assert.h>
@@ -18,6 +19,9 @@ namespace __node
     };
 }
 
+template <typename T>
+class LinkedList;
+
 template <typename T>
 class Iterator
 {
@@ -53,6 +57,7 @@ public:
     }
 
 private:
+    friend class LinkedList<T>;
     std::shared_ptr<__node::Node<T>> current;
 };
 
@@ -76,6 +81,30 @@ public:
             add(item);
     }
 
+    // copies get their own nodes, otherwise clearing one list would clear the other
+    LinkedList(const LinkedList &other) : LinkedList()
+    {
+        for (const T &item : other)
+            add(item);
+    }
+
+    LinkedList(LinkedList &&other) : LinkedList() { other.swap(*this); }
+
+    LinkedList &operator=(const LinkedList &other)
+    {
+        LinkedList(other).swap(*this);
+        return *this;
+    }
+
+    LinkedList &operator=(LinkedList &&other)
+    {
+        LinkedList(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    // the default destructor would release the nodes recursively, one stack frame per node
+    ~LinkedList() { clear(); }
+
     // add item to the linked list, O(1)
     void add(const T item)
     {
@@ -112,6 +141,93 @@ public:
         --length;
     }
 
+    // remove all items, O(n) but without recursion
+    void clear()
+    {
+        // each node's next_node is moved out before the node is released, so releasing it never releases the rest of the list
+        std::shared_ptr<__node::Node<T>> current{std::move(head->next_node)};
+        while (current)
+            current = std::move(current->next_node);
+        last = head;
+        length = 0;
+    }
+
+    // move all of other's items onto the end of this list, leaving other empty, O(1)
+    void splice(LinkedList &other)
+    {
+        if (other.length == 0 || &other == this)
+            return;
+        last->next_node = std::move(other.head->next_node);
+        last = other.last;
+        length += other.length;
+        other.last = other.head;
+        other.length = 0;
+    }
+
+    // move the items after before_first and before last out of other, and insert them after pos, like std::forward_list
+    // pos and before_first can be before_begin(), last can be end(), pos mustn't be one of the items moved
+    // the nodes are relinked, so iterators to the moved items stay valid and now refer to this list
+    // O(1) within a list, or O(number of items moved) between lists, to count them
+    void splice_after(const Iterator<T> pos, LinkedList &other, const Iterator<T> before_first, const Iterator<T> last)
+    {
+        std::shared_ptr<__node::Node<T>> first_node{before_first.current->next_node};
+        if (first_node == last.current || pos == before_first)
+            return;
+        std::shared_ptr<__node::Node<T>> last_node{first_node};
+        int count{1};
+        if (&other == this)
+            while (last_node->next_node != last.current)
+                last_node = last_node->next_node;
+        else
+            for (; last_node->next_node != last.current; ++count)
+                last_node = last_node->next_node;
+
+        before_first.current->next_node = last.current;
+        if (other.last == last_node)
+            other.last = before_first.current;
+        last_node->next_node = std::move(pos.current->next_node);
+        pos.current->next_node = std::move(first_node);
+        if (this->last == pos.current)
+            this->last = last_node;
+        if (&other != this)
+        {
+            other.length -= count;
+            length += count;
+        }
+    }
+
+    // merge other's items into this list, both sorted by compare, leaving other empty
+    // the nodes are relinked rather than copied, and equal items from this list stay before other's, O(n + m)
+    template <typename Compare = std::less<T>>
+    void merge(LinkedList &other, const Compare &compare = Compare{})
+    {
+        if (other.length == 0 || &other == this)
+            return;
+        std::shared_ptr<__node::Node<T>> current{head}; // the items up to current are merged
+        std::shared_ptr<__node::Node<T>> other_current{std::move(other.head->next_node)};
+        while (other_current)
+        {
+            if (!current->next_node)
+            {
+                // the rest of other goes on the end
+                current->next_node = std::move(other_current);
+                last = other.last;
+                break;
+            }
+            if (compare(other_current->item, current->next_node->item))
+            {
+                std::shared_ptr<__node::Node<T>> next_other{std::move(other_current->next_node)};
+                other_current->next_node = std::move(current->next_node);
+                current->next_node = other_current;
+                other_current = std::move(next_other);
+            }
+            current = current->next_node;
+        }
+        length += other.length;
+        other.last = other.head;
+        other.length = 0;
+    }
+
     T back() const { return last->item; }
 
     // get item, note this is O(n) and inefficient
@@ -136,12 +252,22 @@ public:
 
     int size() const { return length; }
 
-    operator bool() { return size() > 0; }
+    explicit operator bool() const { return size() > 0; }
+
+    // iterator to the position before the first item, for splice_after
+    Iterator<T> before_begin() const { return Iterator<T>(head); }
 
     Iterator<T> begin() const { return Iterator<T>(head->next_node); }
 
     Iterator<T> end() const { return Iterator<T>(); }
 
+    void swap(LinkedList &other) noexcept
+    {
+        std::swap(this->head, other.head);
+        std::swap(this->last, other.last);
+        std::swap(this->length, other.length);
+    }
+
 private:
     std::shared_ptr<__node::Node<T>> head; // points to 1 node before the first item
     std::shared_ptr<__node::Node<T>> last; // points to the last item
@@ -259,6 +385,147 @@ void test_linked_list_iterator()
     ctest::assert_equal(enumerated, expected_result);
 }
 
+void test_linked_list_clear()
+{
+    LinkedList<int> list{1, 2, 3};
+    list.clear();
+    assert(!list);
+    ctest::assert_equal(list.items(), std::vector<int>{});
+    list.add(4);
+    ctest::assert_equal(list.items(), std::vector<int>{4});
+    ctest::assert_equal(list.back(), 4);
+
+    // destroying a long list mustn't overflow the stack
+    LinkedList<int> long_list{};
+    for (int i = 0; i < 1000000; ++i)
+        long_list.add(i);
+}
+
+void test_linked_list_splice()
+{
+    LinkedList<int> list{1, 2};
+    LinkedList<int> other{3, 4};
+    list.splice(other);
+    ctest::assert_equal(list.items(), std::vector<int>{1, 2, 3, 4});
+    ctest::assert_equal(list.size(), 4);
+    ctest::assert_equal(list.back(), 4);
+    assert(!other);
+    ctest::assert_equal(other.items(), std::vector<int>{});
+
+    // both lists can still be added to
+    other.add(5);
+    list.add(6);
+    ctest::assert_equal(list.items(), std::vector<int>{1, 2, 3, 4, 6});
+    ctest::assert_equal(other.items(), std::vector<int>{5});
+
+    LinkedList<int> empty{};
+    empty.splice(other);
+    ctest::assert_equal(empty.items(), std::vector<int>{5});
+    list.splice(other);
+    ctest::assert_equal(list.size(), 5);
+}
+
+void test_linked_list_splice_after()
+{
+    LinkedList<int> list{1, 2, 3};
+    LinkedList<int> other{4, 5, 6, 7};
+    // move 5 and 6 to after 1
+    Iterator<int> four{other.begin()};
+    Iterator<int> seven{std::next(four, 3)};
+    list.splice_after(list.begin(), other, four, seven);
+    ctest::assert_equal(list.items(), std::vector<int>{1, 5, 6, 2, 3});
+    ctest::assert_equal(other.items(), std::vector<int>{4, 7});
+    ctest::assert_equal(list.size(), 5);
+    ctest::assert_equal(other.size(), 2);
+
+    // the rest of other onto the end of list, and other's last item is updated
+    list.splice_after(std::next(list.begin(), 4), other, other.before_begin(), other.end());
+    ctest::assert_equal(list.items(), std::vector<int>{1, 5, 6, 2, 3, 4, 7});
+    ctest::assert_equal(list.back(), 7);
+    assert(!other);
+    other.add(8);
+    ctest::assert_equal(other.items(), std::vector<int>{8});
+
+    // within a list, moving the end to the front
+    list.splice_after(list.before_begin(), list, std::next(list.begin(), 4), list.end());
+    ctest::assert_equal(list.items(), std::vector<int>{4, 7, 1, 5, 6, 2, 3});
+    ctest::assert_equal(list.back(), 3);
+    ctest::assert_equal(list.size(), 7);
+    list.add(9);
+    ctest::assert_equal(list.back(), 9);
+
+    // empty ranges do nothing
+    list.splice_after(list.begin(), other, other.begin(), other.end());
+    ctest::assert_equal(list.size(), 8);
+    ctest::assert_equal(other.items(), std::vector<int>{8});
+}
+
+void test_linked_list_merge()
+{
+    LinkedList<int> list{1, 3, 3, 8};
+    LinkedList<int> other{0, 2, 3, 9, 10};
+    list.merge(other);
+    ctest::assert_equal(list.items(), std::vector<int>{0, 1, 2, 3, 3, 3, 8, 9, 10});
+    ctest::assert_equal(list.size(), 9);
+    ctest::assert_equal(list.back(), 10);
+    assert(!other);
+    list.add(11);
+    other.add(1);
+    ctest::assert_equal(other.items(), std::vector<int>{1});
+
+    // equal items from this list come first
+    LinkedList<int> tens{10, 20};
+    LinkedList<int> more_tens{11, 21};
+    tens.merge(more_tens, [](const int a, const int b)
+               { return a / 10 < b / 10; });
+    ctest::assert_equal(tens.items(), std::vector<int>{10, 11, 20, 21});
+    ctest::assert_equal(tens.back(), 21);
+
+    // merging into an empty list, and with a different order
+    LinkedList<int> empty{};
+    LinkedList<int> descending{5, 3, 1};
+    empty.merge(descending, std::greater<int>());
+    ctest::assert_equal(empty.items(), std::vector<int>{5, 3, 1});
+    ctest::assert_equal(empty.back(), 1);
+}
+
+void test_linked_list_copy()
+{
+    LinkedList<int> list{1, 2, 3};
+    LinkedList<int> copy{list};
+    copy.add(4);
+    ctest::assert_equal(list.items(), std::vector<int>{1, 2, 3});
+    ctest::assert_equal(copy.items(), std::vector<int>{1, 2, 3, 4});
+
+    LinkedList<int> moved{std::move(copy)};
+    ctest::assert_equal(moved.items(), std::vector<int>{1, 2, 3, 4});
+    list = moved;
+    moved.clear();
+    ctest::assert_equal(list.items(), std::vector<int>{1, 2, 3, 4});
+}
+
+// Per element cost of iterating through a type erased LinkedList, compared to iterating it directly
+void benchmark_generic_iterator()
+{
+    static_assert(__itertools_utils::GenericIterator<int>::fits_inline<Iterator<int>>);
+    LinkedList<int> list{};
+    for (const int i : itertools::range(0, 1000000))
+        list.add(i);
+
+    const int repeats{10};
+    long direct_total{0};
+    long erased_total{0};
+    const double direct_seconds{ctest::time_it([&list, &direct_total]()
+                                               { for (const int item : list) direct_total += item; },
+                                               repeats)};
+    const double erased_seconds{ctest::time_it([&list, &erased_total]()
+                                               { for (const int item : __itertools_utils::GenericRange<int>(list)) erased_total += item; },
+                                               repeats)};
+    ctest::assert_equal(direct_total, erased_total);
+    std::cout << "LinkedList<int> ns per element: direct " << direct_seconds * 1e9 / list.size()
+              << ", type erased " << erased_seconds * 1e9 / list.size() << std::endl;
+}
+
 int main()
 {
     test_node();
@@ -268,4 +535,10 @@ int main()
     test_linked_list_remove();
     test_linked_list_bool();
     test_linked_list_iterator();
+    test_linked_list_clear();
+    test_linked_list_splice();
+    test_linked_list_splice_after();
+    test_linked_list_merge();
+    test_linked_list_copy();
+    benchmark_generic_iterator();
 }
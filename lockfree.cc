@@ -0,0 +1,152 @@
+#include <assert.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <random>
+#include <set>
+#include <atomic>
+#include <algorithm>
+#include "lockfree.h"
+#include "ctest.h"
+
+void test_treiber_stack()
+{
+    TreiberStack<int> stack{};
+    assert(stack.empty());
+    ctest::assert_equal(stack.pop(), std::optional<int>{});
+    stack.push(1);
+    stack.push(2);
+    assert(!stack.empty());
+    ctest::assert_equal(stack.pop(), 2);
+    ctest::assert_equal(stack.pop(), 1);
+    ctest::assert_equal(stack.pop(), std::optional<int>{});
+    assert(stack.empty());
+}
+
+void test_treiber_stack_threads()
+{
+    // every thread pushes and pops at once, every pushed item must be popped exactly once
+    const int items_per_thread{100000};
+    TreiberStack<int> stack{};
+    std::vector<std::vector<int>> popped(ctest::NUM_THREADS);
+    ctest::run_threads([&](const int thread)
+                { for (int i = 0; i < items_per_thread; ++i)
+                  {
+                      stack.push(thread * items_per_thread + i);
+                      if (i % 2 == 1)
+                          for (int j = 0; j < 2; ++j)
+                              if (const std::optional<int> item = stack.pop())
+                                  popped[thread].push_back(*item);
+                  } });
+    std::vector<int> all_popped{};
+    for (const std::vector<int> &items : popped)
+        all_popped.insert(all_popped.end(), items.begin(), items.end());
+    while (const std::optional<int> item = stack.pop())
+        all_popped.push_back(*item);
+
+    std::sort(all_popped.begin(), all_popped.end());
+    ctest::assert_equal(static_cast<int>(all_popped.size()), ctest::NUM_THREADS * items_per_thread);
+    for (int i = 0; i < ctest::NUM_THREADS * items_per_thread; ++i)
+        ctest::assert_equal(all_popped[i], i);
+}
+
+void test_ordered_list()
+{
+    OrderedList<int> list{};
+    assert(list.add(3));
+    assert(list.add(1));
+    assert(list.add(2));
+    assert(!list.add(2));
+    ctest::assert_equal(list.items(), std::vector<int>{1, 2, 3});
+    assert(list.contains(1));
+    assert(!list.contains(4));
+
+    assert(list.remove(2));
+    assert(!list.remove(2));
+    assert(!list.contains(2));
+    assert(list.remove(3));
+    ctest::assert_equal(list.items(), std::vector<int>{1});
+    assert(list.add(0));
+    ctest::assert_equal(list.items(), std::vector<int>{0, 1});
+}
+
+void test_ordered_list_threads()
+{
+    // each thread adds and removes its own items at random, while interleaving with every other thread's items
+    const int items_per_thread{200};
+    OrderedList<int> list{};
+    std::vector<std::set<int>> expected(ctest::NUM_THREADS);
+    ctest::run_threads([&](const int thread)
+                { std::mt19937 generator(thread);
+                  for (int i = 0; i < 20000; ++i)
+                  {
+                      const int item = (generator() % items_per_thread) * ctest::NUM_THREADS + thread;
+                      if (generator() % 2)
+                          ctest::assert_equal(list.add(item), expected[thread].insert(item).second);
+                      else
+                          ctest::assert_equal(list.remove(item), expected[thread].erase(item) == 1);
+                      ctest::assert_equal(list.contains(item), expected[thread].contains(item));
+                  } });
+    std::set<int> all_expected{};
+    for (const std::set<int> &items : expected)
+        all_expected.insert(items.begin(), items.end());
+    ctest::assert_equal(list.items(), std::vector<int>(all_expected.begin(), all_expected.end()));
+}
+
+void test_ordered_list_contended()
+{
+    // every thread tries to add, then remove, the same items, each must succeed for exactly one thread
+    const int num_items{2000};
+    OrderedList<int> list{};
+    std::atomic<int> added{0};
+    std::atomic<int> removed{0};
+    ctest::run_threads([&](const int thread)
+                { for (int i = 0; i < num_items; ++i)
+                      added += list.add((i * 7 + thread) % num_items); });
+    ctest::run_threads([&](const int thread)
+                { for (int i = 0; i < num_items; ++i)
+                      removed += list.remove((i * 13 + thread) % num_items); });
+    ctest::assert_equal(added.load(), num_items);
+    ctest::assert_equal(removed.load(), num_items);
+    ctest::assert_equal(list.items(), std::vector<int>{});
+}
+
+// Per operation cost of pushing and popping from many threads, compared to a vector behind a mutex
+void benchmark_treiber_stack()
+{
+    const int ops_per_thread{200000};
+    TreiberStack<int> stack{};
+    const double lockfree_seconds{ctest::time_it([&stack]()
+                                                 { ctest::run_threads([&stack](const int)
+                                                               { for (int i = 0; i < ops_per_thread; ++i)
+                                                                 {
+                                                                     stack.push(i);
+                                                                     stack.pop();
+                                                                 } }); })};
+    std::vector<int> vector{};
+    std::mutex mutex{};
+    const double locked_seconds{ctest::time_it([&vector, &mutex]()
+                                               { ctest::run_threads([&vector, &mutex](const int)
+                                                             { for (int i = 0; i < ops_per_thread; ++i)
+                                                               {
+                                                                   {
+                                                                       std::lock_guard<std::mutex> lock{mutex};
+                                                                       vector.push_back(i);
+                                                                   }
+                                                                   std::lock_guard<std::mutex> lock{mutex};
+                                                                   vector.pop_back();
+                                                               } }); })};
+    const int num_ops{2 * ctest::NUM_THREADS * ops_per_thread};
+    std::cout << "ns per stack operation with " << ctest::NUM_THREADS << " threads: lock free " << lockfree_seconds * 1e9 / num_ops
+              << ", mutex " << locked_seconds * 1e9 / num_ops << std::endl;
+}
+
+int main()
+{
+    test_treiber_stack();
+    test_treiber_stack_threads();
+    test_ordered_list();
+    test_ordered_list_threads();
+    test_ordered_list_contended();
+    benchmark_treiber_stack();
+}
@@ -0,0 +1,375 @@
+#ifndef CPP_LEARNING_LOCKFREE
+#define CPP_LEARNING_LOCKFREE
+
+#include <atomic>
+#include <array>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include "thread_registry.h"
+
+namespace lockfree
+{
+    // hazard pointers each thread has, the ordered list needs 3 (the previous, current and next node)
+    constexpr int HAZARDS_PER_THREAD{3};
+    // a thread frees its retired nodes once it has this many, more than the number of hazard pointers
+    // so each scan frees at least half of them and freeing is amortised O(1) per node
+    constexpr size_t RETIRE_SCAN_THRESHOLD{2 * thread_registry::MAX_THREADS * HAZARDS_PER_THREAD};
+}
+
+namespace __lockfree_utils
+{
+    struct Retired
+    {
+        void *pointer;
+        void (*deleter)(void *);
+    };
+
+    struct HazardRecord
+    {
+        std::array<std::atomic<void *>, lockfree::HAZARDS_PER_THREAD> hazards{};
+    };
+
+    // Every thread's hazard pointers, a retired node can be freed once none of them point to it
+    class HazardDomain
+    {
+    public:
+        static HazardDomain &instance()
+        {
+            static HazardDomain domain{};
+            return domain;
+        }
+
+        HazardRecord *acquire_record() { return registry.acquire(); }
+
+        void release_record(HazardRecord *record)
+        {
+            for (std::atomic<void *> &hazard : record->hazards)
+                hazard.store(nullptr, std::memory_order_release);
+            registry.release(record);
+        }
+
+        // free the retired nodes that no thread has a hazard pointer to, the rest stay in retired
+        void scan(std::vector<Retired> &retired)
+        {
+            registry.adopt_orphans(retired);
+
+            std::vector<void *> hazardous{};
+            registry.for_each([&hazardous](const HazardRecord &record)
+                              {
+                                  for (const std::atomic<void *> &hazard : record.hazards)
+                                      if (void *pointer = hazard.load())
+                                          hazardous.push_back(pointer); });
+            std::sort(hazardous.begin(), hazardous.end());
+
+            const auto still_hazardous{std::partition(retired.begin(), retired.end(), [&hazardous](const Retired &item)
+                                                      { return std::binary_search(hazardous.begin(), hazardous.end(), item.pointer); })};
+            for (auto iter = still_hazardous; iter != retired.end(); ++iter)
+                iter->deleter(iter->pointer);
+            retired.erase(still_hazardous, retired.end());
+        }
+
+        // nodes from an exiting thread that were still hazardous
+        void orphan(const std::vector<Retired> &retired) { registry.orphan(retired); }
+
+    private:
+        ThreadRegistry<HazardRecord, Retired> registry;
+    };
+
+    // A thread's hazard pointers and the nodes it has retired but not yet freed
+    struct ThreadState
+    {
+        HazardRecord *record;
+        std::vector<Retired> retired;
+
+        ThreadState() : record{HazardDomain::instance().acquire_record()}, retired{} {}
+
+        // whatever is still hazardous when the thread exits is left for another thread's scan
+        ~ThreadState()
+        {
+            HazardDomain &domain{HazardDomain::instance()};
+            domain.release_record(record);
+            domain.scan(retired);
+            if (!retired.empty())
+                domain.orphan(retired);
+        }
+    };
+
+    inline ThreadState &thread_state()
+    {
+        thread_local ThreadState state{};
+        return state;
+    }
+}
+
+namespace lockfree
+{
+    // Stops the node it points to from being freed while this thread reads it
+    // Each index is one of the thread's hazard pointers, so a thread can only have one HazardPointer per index at a time
+    class HazardPointer
+    {
+    public:
+        explicit HazardPointer(const int index) : hazard{&__lockfree_utils::thread_state().record->hazards[index]} {}
+
+        HazardPointer(const HazardPointer &other) = delete;
+        HazardPointer &operator=(const HazardPointer &other) = delete;
+
+        ~HazardPointer() { clear(); }
+
+        // load source and protect what it points to
+        // the pointer is published then source is read again, if it is unchanged the node can't have been retired before we protected it
+        template <typename Node>
+        Node *protect(const std::atomic<Node *> &source)
+        {
+            Node *pointer{source.load()};
+            while (true)
+            {
+                hazard->store(pointer);
+                Node *const reloaded{source.load()};
+                if (reloaded == pointer)
+                    return pointer;
+                pointer = reloaded;
+            }
+        }
+
+        // protect pointer, the caller must check it is still reachable afterwards
+        void set(void *pointer) { hazard->store(pointer); }
+
+        void clear() { hazard->store(nullptr, std::memory_order_release); }
+
+    private:
+        std::atomic<void *> *hazard;
+    };
+
+    // Free node once no thread has a hazard pointer to it. The node must already be unreachable
+    template <typename Node>
+    void retire(Node *node)
+    {
+        __lockfree_utils::ThreadState &state{__lockfree_utils::thread_state()};
+        state.retired.push_back(__lockfree_utils::Retired{node, [](void *pointer)
+                                                          { delete static_cast<Node *>(pointer); }});
+        if (state.retired.size() >= RETIRE_SCAN_THRESHOLD)
+            __lockfree_utils::HazardDomain::instance().scan(state.retired);
+    }
+}
+
+// Stack that any number of threads can push to and pop from without locks
+// The top is swapped with a compare and exchange, and popped nodes are freed through hazard pointers,
+// so a node can't be freed (or freed and reallocated, the ABA problem) while another thread is popping it
+template <typename T>
+class TreiberStack
+{
+    struct Node
+    {
+        T item;
+        Node *next;
+    };
+
+public:
+    TreiberStack() : top{nullptr} {}
+
+    TreiberStack(const TreiberStack &other) = delete;
+    TreiberStack &operator=(const TreiberStack &other) = delete;
+
+    ~TreiberStack()
+    {
+        Node *node{top.load()};
+        while (node)
+        {
+            Node *const next{node->next};
+            delete node;
+            node = next;
+        }
+    }
+
+    void push(const T &item)
+    {
+        Node *const node{new Node{item, top.load(std::memory_order_relaxed)}};
+        while (!top.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+            ;
+    }
+
+    // remove and return the top item. If the stack is empty returns nullopt
+    std::optional<T> pop()
+    {
+        lockfree::HazardPointer hazard{0};
+        Node *node;
+        while (true)
+        {
+            node = hazard.protect(top);
+            if (!node)
+                return std::nullopt;
+            if (top.compare_exchange_weak(node, node->next))
+                break;
+        }
+        hazard.clear();
+        std::optional<T> item{std::move(node->item)};
+        lockfree::retire(node);
+        return item;
+    }
+
+    bool empty() const { return top.load() == nullptr; }
+
+private:
+    std::atomic<Node *> top;
+};
+
+// Sorted set as a linked list that any number of threads can add to, remove from and search without locks (Harris and Michael's list)
+// Removing first marks the node's next link, so no node can be inserted after it, then unlinks it
+// Searches unlink any marked nodes they pass, and hold hazard pointers to the nodes either side of where they are
+template <typename T>
+class OrderedList
+{
+    struct Node
+    {
+        T item;
+        std::atomic<uintptr_t> next; // pointer to the next node, with the lowest bit set once this node is removed
+    };
+
+    static constexpr uintptr_t MARK{1};
+
+    struct Position
+    {
+        std::atomic<uintptr_t> *prev; // the link to curr
+        Node *curr;                   // the first node with an item that isn't less than the searched item
+        bool found;
+    };
+
+public:
+    OrderedList() : head{0} {}
+
+    OrderedList(const OrderedList &other) = delete;
+    OrderedList &operator=(const OrderedList &other) = delete;
+
+    ~OrderedList()
+    {
+        Node *node{to_node(head.load())};
+        while (node)
+        {
+            Node *const next{to_node(node->next.load())};
+            delete node;
+            node = next;
+        }
+    }
+
+    // add item, returns false if it was already in the list
+    bool add(const T &item)
+    {
+        lockfree::HazardPointer hazard0{0}, hazard1{1}, hazard2{2};
+        Node *const node{new Node{item, 0}};
+        while (true)
+        {
+            const Position position{find(item, &hazard0, &hazard1, &hazard2)};
+            if (position.found)
+            {
+                delete node;
+                return false;
+            }
+            node->next.store(to_link(position.curr), std::memory_order_relaxed);
+            uintptr_t expected{to_link(position.curr)};
+            if (position.prev->compare_exchange_strong(expected, to_link(node)))
+                return true;
+        }
+    }
+
+    // remove item, returns false if it wasn't in the list
+    bool remove(const T &item)
+    {
+        lockfree::HazardPointer hazard0{0}, hazard1{1}, hazard2{2};
+        while (true)
+        {
+            const Position position{find(item, &hazard0, &hazard1, &hazard2)};
+            if (!position.found)
+                return false;
+            uintptr_t next{position.curr->next.load()};
+            if (next & MARK)
+                continue; // another thread is removing it, the next find will finish unlinking it
+            if (!position.curr->next.compare_exchange_strong(next, next | MARK))
+                continue;
+
+            // marking removes the item, if unlinking fails a find will unlink it
+            uintptr_t expected{to_link(position.curr)};
+            if (position.prev->compare_exchange_strong(expected, next))
+                lockfree::retire(position.curr);
+            else
+                find(item, &hazard0, &hazard1, &hazard2);
+            return true;
+        }
+    }
+
+    bool contains(const T &item)
+    {
+        lockfree::HazardPointer hazard0{0}, hazard1{1}, hazard2{2};
+        return find(item, &hazard0, &hazard1, &hazard2).found;
+    }
+
+    // all items in order, only consistent while no other thread is modifying the list
+    std::vector<T> items() const
+    {
+        std::vector<T> result{};
+        for (const Node *node = to_node(head.load()); node; node = to_node(node->next.load()))
+            if (!(node->next.load() & MARK))
+                result.push_back(node->item);
+        return result;
+    }
+
+private:
+    std::atomic<uintptr_t> head;
+
+    static Node *to_node(const uintptr_t link) { return reinterpret_cast<Node *>(link & ~MARK); }
+
+    static uintptr_t to_link(const Node *node) { return reinterpret_cast<uintptr_t>(node); }
+
+    // find where item is or would go, unlinking marked nodes on the way
+    // when it returns the node owning prev and curr are protected by the hazard pointers
+    Position find(const T &item, lockfree::HazardPointer *prev_hazard, lockfree::HazardPointer *curr_hazard, lockfree::HazardPointer *next_hazard)
+    {
+        while (true)
+        {
+            std::optional<Position> position{try_find(item, prev_hazard, curr_hazard, next_hazard)};
+            if (position)
+                return *position;
+        }
+    }
+
+    // returns nullopt when another thread changed the list under us, so the search has to start again
+    std::optional<Position> try_find(const T &item, lockfree::HazardPointer *prev_hazard, lockfree::HazardPointer *curr_hazard, lockfree::HazardPointer *next_hazard)
+    {
+        std::atomic<uintptr_t> *prev{&head};
+        Node *curr{to_node(prev->load())};
+        curr_hazard->set(curr);
+
+        while (true)
+        {
+            // curr was protected before this check, so if prev still links to it (and prev isn't marked), it wasn't retired
+            if (prev->load() != to_link(curr))
+                return std::nullopt;
+            if (!curr)
+                return Position{prev, nullptr, false};
+            const uintptr_t next_link{curr->next.load()};
+            Node *const next{to_node(next_link)};
+            next_hazard->set(next);
+
+            if (!(next_link & MARK))
+            {
+                if (!(curr->item < item))
+                    return Position{prev, curr, !(item < curr->item)};
+                prev = &curr->next;
+                std::swap(prev_hazard, curr_hazard); // keep protecting curr, as it now owns prev
+            }
+            else
+            {
+                uintptr_t expected{to_link(curr)};
+                if (!prev->compare_exchange_strong(expected, to_link(next)))
+                    return std::nullopt;
+                lockfree::retire(curr);
+            }
+            curr = next;
+            std::swap(curr_hazard, next_hazard);
+        }
+    }
+};
+
+#endif
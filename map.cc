@@ -1,6 +1,13 @@
 #include <functional>
 #include <tuple>
+#include <vector>
+#include <optional>
+#include <utility>
+#include <string>
+#include <memory_resource>
 #include "set.h"
+#include "arena.h"
+#include "intern.h"
 #include "concepts.h"
 #include "functools.h"
 #include "ctest.h"
@@ -17,10 +24,11 @@ class Map
 public:
     typedef std::tuple<Key, Value> Item;
 
-    constexpr Map(const size_t &size = set::HASHSET_INITIAL_SIZE)
-        : map_set{Set<Key, Item>(get_elem<0, Key, Value>, size)} {};
+    constexpr Map(const size_t &size = set::HASHSET_INITIAL_SIZE, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : map_set{Set<Key, Item>(get_elem<0, Key, Value>, size, resource)} {};
 
-    constexpr Map(std::initializer_list<Item> items, const size_t &size = set::HASHSET_INITIAL_SIZE) : Map(size)
+    constexpr Map(std::initializer_list<Item> items, const size_t &size = set::HASHSET_INITIAL_SIZE,
+                  std::pmr::memory_resource *resource = std::pmr::get_default_resource()) : Map(size, resource)
     {
         for (const Item &item : items)
             set(item);
@@ -52,6 +60,19 @@ public:
         return get(key);
     }
 
+    // remove the item with this key, if there is one
+    void remove(const Key &key)
+    {
+        const std::optional<Item> item{map_set.get(key)};
+        if (item)
+            map_set.remove(item.value());
+    }
+
+    bool contains(const Key &key) const
+    {
+        return bool(map_set.get(key));
+    }
+
     void update(const Map<Key, Value> &other)
     {
         for (const Item &item : other.items())
@@ -63,6 +84,13 @@ public:
         return map_set.items();
     }
 
+    // call func on every item, without copying them
+    template <typename Func>
+    void for_each(const Func &func) const
+    {
+        map_set.for_each(func);
+    }
+
     size_t size() const
     {
         return map_set.size();
@@ -81,6 +109,166 @@ private:
     Set<Key, Item> map_set;
 };
 
+// Table of records with a field for each of Fields, looked up by key
+// The records are stored as a structure of arrays: each field is its own contiguous column, and a Map gives each key's row
+// So scanning one field of every record only reads that field's column, and the loop over it can be vectorised
+// Removing a row moves the last row into its place, so row indexes change when rows are removed
+template <Hashable Key, typename... Fields>
+class ColumnarMap
+{
+    static_assert((!std::same_as<Fields, bool> && ...), "vector<bool> packs its bits, so a bool column isn't contiguous, use char instead");
+
+public:
+    typedef std::tuple<Fields...> Row;
+
+    template <size_t Column>
+    using column_type = std::tuple_element_t<Column, Row>;
+
+    // the index and columns are allocated from resource, which must outlive the table. Copies use the default resource
+    explicit ColumnarMap(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : row_index{set::HASHSET_INITIAL_SIZE, resource}, row_keys{resource}, columns{std::pmr::vector<Fields>(resource)...} {}
+
+    ColumnarMap(std::initializer_list<std::tuple<Key, Fields...>> rows, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : ColumnarMap(resource)
+    {
+        reserve(rows.size());
+        for (const std::tuple<Key, Fields...> &row : rows)
+            std::apply([this](const Key &key, const Fields &...fields)
+                       { set(key, fields...); },
+                       row);
+    }
+
+    // set the fields of the row with this key, adding a row if the key is new. Returns the row's index
+    size_t set(const Key &key, const Fields &...fields)
+    {
+        const std::optional<size_t> existing{find(key)};
+        if (existing)
+        {
+            const size_t row{existing.value()};
+            std::apply([row, &fields...](auto &...column)
+                       { ((column[row] = fields), ...); },
+                       columns);
+            return row;
+        }
+        row_index.set(key, row_keys.size());
+        row_keys.push_back(key);
+        std::apply([&fields...](auto &...column)
+                   { (column.push_back(fields), ...); },
+                   columns);
+        return row_keys.size() - 1;
+    }
+
+    size_t set(const Key &key, const Row &row)
+    {
+        return std::apply([this, &key](const Fields &...fields)
+                          { return set(key, fields...); },
+                          row);
+    }
+
+    // the index of the row with this key
+    std::optional<size_t> find(const Key &key) const
+    {
+        return row_index.get(key);
+    }
+
+    bool contains(const Key &key) const
+    {
+        return row_index.contains(key);
+    }
+
+    // copy the fields of the row with this key into a tuple
+    std::optional<Row> get(const Key &key) const
+    {
+        return functools::transform([this](const size_t row)
+                                    { return this->row(row); },
+                                    find(key));
+    }
+
+    std::optional<Row> operator[](const Key &key) const
+    {
+        return get(key);
+    }
+
+    Row row(const size_t index) const
+    {
+        return std::apply([index](const auto &...column)
+                          { return Row{column[index]...}; },
+                          columns);
+    }
+
+    // remove the row with this key, the last row is moved into its place
+    void remove(const Key &key)
+    {
+        const std::optional<size_t> found{find(key)};
+        if (!found)
+            return;
+        const size_t row{found.value()};
+        const size_t last{row_keys.size() - 1};
+        row_index.remove(key);
+        if (row != last)
+        {
+            row_index.set(row_keys[last], row);
+            row_keys[row] = std::move(row_keys[last]);
+            std::apply([row, last](auto &...column)
+                       { ((column[row] = std::move(column[last])), ...); },
+                       columns);
+        }
+        row_keys.pop_back();
+        std::apply([](auto &...column)
+                   { (column.pop_back(), ...); },
+                   columns);
+    }
+
+    // every row's value of one field, in row order
+    template <size_t Column>
+    const std::pmr::vector<column_type<Column>> &column() const
+    {
+        return std::get<Column>(columns);
+    }
+
+    // a field of one row, which can be updated in place
+    template <size_t Column>
+    decltype(auto) field(const size_t row)
+    {
+        return std::get<Column>(columns)[row];
+    }
+
+    template <size_t Column>
+    decltype(auto) field(const size_t row) const
+    {
+        return std::get<Column>(columns)[row];
+    }
+
+    // the key of each row, in row order
+    const std::pmr::vector<Key> &keys() const
+    {
+        return row_keys;
+    }
+
+    void reserve(const size_t rows)
+    {
+        row_keys.reserve(rows);
+        std::apply([rows](auto &...column)
+                   { (column.reserve(rows), ...); },
+                   columns);
+    }
+
+    size_t size() const
+    {
+        return row_keys.size();
+    }
+
+    explicit operator bool() const
+    {
+        return size() > 0;
+    }
+
+private:
+    Map<Key, size_t> row_index;
+    std::pmr::vector<Key> row_keys;
+    std::tuple<std::pmr::vector<Fields>...> columns;
+};
+
 void test_tuple()
 {
     std::tuple<int, bool> test_tuple{10, false};
@@ -140,6 +328,106 @@ void test_map_initializer_list()
     map2.set(1, "there");
     map2.set(0, "hello");
     ctest::assert_equal(map1, map2);
+
+    Map<int, std::string> map3{{0, "hello"}, {1, "world"}};
+    assert(map1 != map3);
+}
+
+void test_map_interned_keys()
+{
+    // repeated keys share one copy of their text, and lookups compare ids instead of strings
+    strlib::InternPool pool{};
+    Map<strlib::InternedString, int> counts{};
+    for (const std::string_view word : strlib::tokenize("to be or not to be"))
+    {
+        const strlib::InternedString key{pool.intern(word)};
+        counts.set(key, counts.get(key, 0) + 1);
+    }
+    ctest::assert_equal(counts.size(), 4);
+    ctest::assert_equal(pool.size(), 4);
+    ctest::assert_equal(counts[pool.intern("to")], 2);
+    ctest::assert_equal(counts[pool.intern("be")], 2);
+    ctest::assert_equal(counts[pool.intern("or")], 1);
+    assert(!counts[pool.intern("question")]);
+}
+
+void test_map_memory_resource()
+{
+    // a map used for one task can live in an arena, nothing it stores comes from the default resource
+    arena::MonotonicArena arena{};
+    {
+        const ctest::ScopedDefaultResource no_default_allocations{std::pmr::null_memory_resource()};
+        Map<int, int> map{set::HASHSET_INITIAL_SIZE, &arena};
+        for (int i = 0; i < 1000; ++i)
+            map.set(i, i * i);
+        ctest::assert_equal(map.get(30), 900);
+        ctest::assert_equal(map.size(), 1000);
+    }
+    assert(arena.allocated_bytes() > 0);
+}
+
+void test_map_remove()
+{
+    Map<int, std::string> map{{0, "hello"}, {1, "there"}};
+    map.remove(0);
+    map.remove(2);
+    ctest::assert_equal(map.size(), 1);
+    assert(!map.contains(0));
+    assert(map.contains(1));
+}
+
+void test_columnar_map()
+{
+    ColumnarMap<std::string, int, double, char> table{{"a", 1, 1.5, 'y'}, {"b", 2, 2.5, 'n'}};
+    ctest::assert_equal(table.size(), 2);
+    ctest::assert_equal(table.find("b"), 1);
+    assert(!table.find("c"));
+    ctest::assert_equal(table.get("a"), std::make_tuple(1, 1.5, 'y'));
+    ctest::assert_equal(table.column<1>(), std::pmr::vector<double>{1.5, 2.5});
+
+    // setting an existing key updates its row in place
+    ctest::assert_equal(table.set("c", 3, 3.5, 'y'), 2);
+    ctest::assert_equal(table.set("a", std::make_tuple(10, 0.5, 'n')), 0);
+    ctest::assert_equal(table.column<0>(), std::pmr::vector<int>{10, 2, 3});
+    table.field<0>(1) += 5;
+    ctest::assert_equal(table["b"], std::make_tuple(7, 2.5, 'n'));
+
+    // the last row fills the gap left by a removed row
+    table.remove("a");
+    table.remove("missing");
+    ctest::assert_equal(table.size(), 2);
+    ctest::assert_equal(table.keys(), std::pmr::vector<std::string>{"c", "b"});
+    ctest::assert_equal(table.find("c"), 0);
+    ctest::assert_equal(table.row(0), std::make_tuple(3, 3.5, 'y'));
+    table.remove("b");
+    table.remove("c");
+    assert(!table);
+    assert(!table.contains("c"));
+}
+
+// Per row cost of summing one field of every record, walking a Map's nodes and scanning a ColumnarMap's column
+void benchmark_columnar_map()
+{
+    const int num_rows{100000};
+    Map<int, std::tuple<double, int, std::string>> map{};
+    ColumnarMap<int, double, int, std::string> table{};
+    table.reserve(num_rows);
+    for (int i = 0; i < num_rows; ++i)
+    {
+        map.set(i, std::make_tuple(i * 0.5, i, strlib::to_str(i)));
+        table.set(i, i * 0.5, i, strlib::to_str(i));
+    }
+
+    double map_total{0};
+    const double map_seconds{ctest::time_it([&map, &map_total]()
+                                            { map.for_each([&map_total](const std::tuple<int, std::tuple<double, int, std::string>> &item)
+                                                           { map_total += std::get<0>(std::get<1>(item)); }); })};
+    double table_total{0};
+    const double table_seconds{ctest::time_it([&table, &table_total]()
+                                              { for (const double value : table.column<0>())
+                                                    table_total += value; })};
+    ctest::assert_equal(map_total, table_total);
+    std::cout << "ns per row scanned: Map " << map_seconds * 1e9 / num_rows << ", ColumnarMap " << table_seconds * 1e9 / num_rows << std::endl;
 }
 
 int main()
@@ -147,4 +435,9 @@ int main()
     test_tuple();
     test_map();
     test_map_initializer_list();
+    test_map_interned_keys();
+    test_map_memory_resource();
+    test_map_remove();
+    test_columnar_map();
+    benchmark_columnar_map();
 }
\ No newline at end of file
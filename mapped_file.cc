@@ -0,0 +1,109 @@
+#include <assert.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <unistd.h>
+#include "mapped_file.h"
+#include "itertools.h"
+#include "functools.h"
+#include "ctest.h"
+
+// write contents to a file in the temp directory, returning its path
+std::string write_temp_file(const std::string &name, const std::string &contents)
+{
+    const std::filesystem::path path{std::filesystem::temp_directory_path() / name};
+    std::ofstream file{path, std::ios::binary};
+    file << contents;
+    return path.string();
+}
+
+void test_mapped_file_contents()
+{
+    const std::string path{write_temp_file("mapped_file_contents.txt", "hello\nthere\n")};
+    strlib::MappedFile file{path};
+    assert(file.is_mapped());
+    ctest::assert_equal(file.contents(), "hello\nthere\n");
+    ctest::assert_equal(file.size(), 12);
+
+    // moving keeps the mapping alive
+    strlib::MappedFile moved{std::move(file)};
+    ctest::assert_equal(moved.contents(), "hello\nthere\n");
+    std::filesystem::remove(path);
+}
+
+void test_mapped_file_lines()
+{
+    const std::string path{write_temp_file("mapped_file_lines.txt", "first line\nsecond\n\nlast")};
+    strlib::MappedFile file{path};
+    ctest::assert_equal(itertools::to_vec(file.lines()), std::vector<std::string_view>{"first line", "second", "", "last"});
+
+    const std::string trailing_path{write_temp_file("mapped_file_trailing.txt", "a\nb\n")};
+    ctest::assert_equal(itertools::to_vec(strlib::MappedFile(trailing_path).lines()), std::vector<std::string_view>{"a", "b"});
+
+    // empty files can't be mapped, but still work
+    const std::string empty_path{write_temp_file("mapped_file_empty.txt", "")};
+    strlib::MappedFile empty{empty_path};
+    assert(!empty.is_mapped());
+    ctest::assert_equal(empty.size(), 0);
+    ctest::assert_equal(itertools::to_vec(empty.lines()), std::vector<std::string_view>{});
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(trailing_path);
+    std::filesystem::remove(empty_path);
+}
+
+void test_mapped_file_fields()
+{
+    const std::string path{write_temp_file("mapped_file_fields.csv", "id,name,score\n1,ann,90\n2,bob,75\n3,cat,82\n")};
+    strlib::MappedFile file{path};
+
+    // pull the score column out of every line after the header
+    std::vector<std::string_view> lines{itertools::to_vec(file.lines())};
+    std::vector<int> scores{};
+    for (const std::string_view line : itertools::slice(lines, 1))
+    {
+        std::vector<std::string_view> fields{itertools::to_vec(strlib::tokenize(line, ','))};
+        scores.push_back(std::stoi(std::string(fields[2])));
+    }
+    ctest::assert_equal(scores, std::vector<int>{90, 75, 82});
+
+    auto above_80{[](const int score)
+                  { return score > 80; }};
+    ctest::assert_equal(functools::filter(above_80, scores), std::vector<int>{90, 82});
+    std::filesystem::remove(path);
+}
+
+void test_mapped_file_pipe()
+{
+    // pipes can't be mapped, so are read into a buffer instead
+    int pipe_fds[2];
+    const int pipe_result{::pipe(pipe_fds)};
+    ctest::assert_equal(pipe_result, 0);
+    const std::string message{"through\na pipe\n"};
+    const ssize_t written{::write(pipe_fds[1], message.data(), message.size())};
+    ctest::assert_equal(written, static_cast<ssize_t>(message.size()));
+    ::close(pipe_fds[1]);
+
+    strlib::MappedFile file{strlib::MappedFile::from_fd(pipe_fds[0])};
+    ::close(pipe_fds[0]);
+    assert(!file.is_mapped());
+    ctest::assert_equal(file.contents(), message);
+    ctest::assert_equal(itertools::to_vec(file.lines()), std::vector<std::string_view>{"through", "a pipe"});
+}
+
+void test_mapped_file_missing()
+{
+    ctest::raises<std::system_error>([]()
+                                     { strlib::MappedFile("/this/file/does/not/exist"); });
+}
+
+int main()
+{
+    test_mapped_file_contents();
+    test_mapped_file_lines();
+    test_mapped_file_fields();
+    test_mapped_file_pipe();
+    test_mapped_file_missing();
+}
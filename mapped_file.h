@@ -0,0 +1,144 @@
+#ifndef STRLIB_MAPPED_FILE
+#define STRLIB_MAPPED_FILE
+
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "strlib.h"
+
+namespace strlib
+{
+    // size of each read when a file can't be memory mapped
+    constexpr size_t MAPPED_FILE_READ_SIZE{1 << 20};
+
+    // Read only view of a whole file's contents
+    // Regular files are memory mapped, so they are paged in lazily and never copied
+    // Anything else (pipes, sockets, files that fail to map) is read into a buffer with large reads
+    class MappedFile
+    {
+    public:
+        MappedFile(const std::string &path) : mapping{nullptr}, mapping_size{0}, buffer{}
+        {
+            const int fd{::open(path.c_str(), O_RDONLY)};
+            if (fd == -1)
+                throw std::system_error(errno, std::generic_category(), path);
+            try
+            {
+                load(fd);
+            }
+            catch (...)
+            {
+                ::close(fd);
+                throw;
+            }
+            // the mapping stays valid after the file is closed
+            ::close(fd);
+        }
+
+        // Read from a file descriptor that is already open, the caller keeps ownership of it
+        static MappedFile from_fd(const int fd)
+        {
+            MappedFile file{};
+            file.load(fd);
+            return file;
+        }
+
+        MappedFile(const MappedFile &other) = delete;
+        MappedFile &operator=(const MappedFile &other) = delete;
+
+        MappedFile(MappedFile &&other) : MappedFile() { other.swap(*this); }
+
+        MappedFile &operator=(MappedFile &&other)
+        {
+            MappedFile(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        ~MappedFile()
+        {
+            if (mapping)
+                ::munmap(mapping, mapping_size);
+            mapping = nullptr;
+        }
+
+        std::string_view contents() const
+        {
+            return (mapping) ? std::string_view(static_cast<const char *>(mapping), mapping_size) : std::string_view(buffer);
+        }
+
+        // Lazy range of the lines in the file, without their newlines
+        // A newline at the very end of the file doesn't start another line, and an empty file has no lines
+        Tokenizer<__strlib_utils::CharDelimiter> lines() const
+        {
+            const std::string_view text{contents()};
+            if (text.empty())
+                return Tokenizer<__strlib_utils::CharDelimiter>(text, {'\n'}, false, false);
+            return tokenize((text.back() == '\n') ? text.substr(0, text.length() - 1) : text, '\n');
+        }
+
+        size_t size() const { return contents().length(); }
+
+        bool is_mapped() const { return mapping != nullptr; }
+
+    private:
+        void *mapping;
+        size_t mapping_size;
+        std::string buffer; // holds the contents when the file isn't mapped
+
+        MappedFile() : mapping{nullptr}, mapping_size{0}, buffer{} {}
+
+        void swap(MappedFile &other) noexcept
+        {
+            std::swap(this->mapping, other.mapping);
+            std::swap(this->mapping_size, other.mapping_size);
+            std::swap(this->buffer, other.buffer);
+        }
+
+        void load(const int fd)
+        {
+            struct stat file_stat;
+            if (::fstat(fd, &file_stat) == -1)
+                throw std::system_error(errno, std::generic_category(), "fstat");
+
+            if (S_ISREG(file_stat.st_mode) && file_stat.st_size > 0)
+            {
+                void *mapped{::mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0)};
+                if (mapped != MAP_FAILED)
+                {
+                    mapping = mapped;
+                    mapping_size = file_stat.st_size;
+                    // pages are read front to back, so the kernel can read ahead aggressively and drop pages behind us
+                    ::madvise(mapping, mapping_size, MADV_SEQUENTIAL);
+                    return;
+                }
+            }
+            read_all(fd);
+        }
+
+        void read_all(const int fd)
+        {
+            size_t used{0};
+            while (true)
+            {
+                buffer.resize(used + MAPPED_FILE_READ_SIZE);
+                const ssize_t bytes_read{::read(fd, buffer.data() + used, MAPPED_FILE_READ_SIZE)};
+                if (bytes_read == -1 && errno == EINTR)
+                    continue;
+                if (bytes_read == -1)
+                    throw std::system_error(errno, std::generic_category(), "read");
+                if (bytes_read == 0)
+                    break;
+                used += bytes_read;
+            }
+            buffer.resize(used);
+            buffer.shrink_to_fit();
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,582 @@
+#include <vector>
+#include <array>
+#include <tuple>
+#include <optional>
+#include <concepts>
+#include <algorithm>
+#include <iterator>
+#include <ranges>
+#include <stdexcept>
+#include <limits>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <assert.h>
+#include "itertools.h"
+#include "ctest.h"
+
+// Ordered map implemented as a B+tree
+// Every item is stored in a leaf, and the leaves are linked in key order so range scans walk them sequentially
+// Nodes hold many keys each, sized to span a few cache lines, so the tree is shallow and each node is scanned from cache
+// Nodes are stored in vectors and refer to each other by index, the same way as BinaryTree
+template <std::totally_ordered Key, std::semiregular Value>
+    requires std::semiregular<Key>
+class OrderedMap
+{
+    // the number of keys in each node, enough to fill 4 cache lines
+    static constexpr uint32_t NODE_CAPACITY{std::max<uint32_t>(4, 256 / sizeof(Key))};
+    static constexpr int32_t NO_NODE{-1};
+
+    // keys and values are kept in separate arrays so searching a leaf only touches its keys
+    struct Leaf
+    {
+        std::array<Key, NODE_CAPACITY> keys;
+        std::array<Value, NODE_CAPACITY> values;
+        uint32_t count{0};
+        int32_t next{NO_NODE}; // the leaf holding the next keys in order
+    };
+
+    // children[i] holds the keys in [keys[i - 1], keys[i]), so children[0] holds every key less than keys[0]
+    struct Inner
+    {
+        std::array<Key, NODE_CAPACITY> keys;
+        std::array<int32_t, NODE_CAPACITY + 1> children;
+        uint32_t count{0}; // number of keys, there is one more child than this
+    };
+
+    // the result of splitting a full node: separator is the smallest key in new_node
+    struct Split
+    {
+        Key separator;
+        int32_t new_node;
+    };
+
+public:
+    typedef std::tuple<Key, Value> Item;
+
+    struct Iterator
+    {
+    public:
+        typedef Item value_type;
+        typedef Item reference;
+        typedef std::ptrdiff_t difference_type;
+        typedef std::forward_iterator_tag iterator_category;
+
+        Iterator() : map{nullptr}, leaf{NO_NODE}, position{0} {}
+
+        // position may be one past the end of the leaf, in which case the iterator moves to the start of the next leaf
+        Iterator(const OrderedMap *map, const int32_t leaf, const uint32_t position) : map{map}, leaf{leaf}, position{position} { skip_leaf_end(); }
+
+        const Key &key() const { return map->leaves[leaf].keys[position]; }
+        const Value &value() const { return map->leaves[leaf].values[position]; }
+
+        reference operator*() const { return std::make_tuple(key(), value()); }
+        Iterator &operator++()
+        {
+            ++position;
+            skip_leaf_end();
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            Iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+        friend bool operator==(const Iterator &iter1, const Iterator &iter2) { return iter1.leaf == iter2.leaf && iter1.position == iter2.position; }
+        friend bool operator!=(const Iterator &iter1, const Iterator &iter2) { return !(iter1 == iter2); }
+
+    private:
+        const OrderedMap *map;
+        int32_t leaf; // NO_NODE at the end
+        uint32_t position;
+
+        void skip_leaf_end()
+        {
+            while (leaf != NO_NODE && position == map->leaves[leaf].count)
+            {
+                leaf = map->leaves[leaf].next;
+                position = 0;
+            }
+        }
+    };
+
+    typedef Iterator iterator;
+    typedef Iterator const_iterator;
+
+    OrderedMap() : leaves(1), inners{}, root{0}, levels{0}, num_items{0} {}
+
+    OrderedMap(std::initializer_list<Item> items) : OrderedMap()
+    {
+        for (const Item &item : items)
+            set(item);
+    }
+
+    // Build the tree directly from items sorted by key, without searching for where each item goes
+    // Leaves are filled completely, so it uses the least memory and is fastest to scan
+    static OrderedMap bulk_load(const std::vector<Item> &sorted_items)
+    {
+        for (size_t i = 1; i < sorted_items.size(); ++i)
+            if (!(std::get<0>(sorted_items[i - 1]) < std::get<0>(sorted_items[i])))
+                throw std::invalid_argument("bulk_load items must be sorted by key without duplicates");
+
+        OrderedMap map{};
+        if (sorted_items.empty())
+            return map;
+        map.leaves.clear();
+        std::vector<int32_t> level_nodes{};
+        std::vector<Key> first_keys{}; // the smallest key under each node in level_nodes
+        for (size_t start = 0; start < sorted_items.size(); start += NODE_CAPACITY)
+        {
+            Leaf &leaf{map.new_leaf()};
+            const int32_t leaf_idx(map.leaves.size() - 1);
+            if (leaf_idx > 0)
+                map.leaves[leaf_idx - 1].next = leaf_idx;
+            leaf.count = std::min<size_t>(NODE_CAPACITY, sorted_items.size() - start);
+            for (uint32_t i = 0; i < leaf.count; ++i)
+                std::tie(leaf.keys[i], leaf.values[i]) = sorted_items[start + i];
+            level_nodes.push_back(leaf_idx);
+            first_keys.push_back(leaf.keys[0]);
+        }
+
+        // build each level of inner nodes from the one below until there is a single root
+        while (level_nodes.size() > 1)
+        {
+            std::vector<int32_t> parent_nodes{};
+            std::vector<Key> parent_first_keys{};
+            for (size_t start = 0; start < level_nodes.size(); start += NODE_CAPACITY + 1)
+            {
+                Inner &inner{map.new_inner()};
+                const size_t num_children{std::min<size_t>(NODE_CAPACITY + 1, level_nodes.size() - start)};
+                inner.count = num_children - 1;
+                for (size_t i = 0; i < num_children; ++i)
+                    inner.children[i] = level_nodes[start + i];
+                for (size_t i = 1; i < num_children; ++i)
+                    inner.keys[i - 1] = first_keys[start + i];
+                parent_nodes.push_back(map.inners.size() - 1);
+                parent_first_keys.push_back(first_keys[start]);
+            }
+            level_nodes = std::move(parent_nodes);
+            first_keys = std::move(parent_first_keys);
+            ++map.levels;
+        }
+        map.root = level_nodes.front();
+        map.num_items = sorted_items.size();
+        return map;
+    }
+
+    // set the value for this key, updating it if the key already exists
+    void set(const Key &key, const Value &value)
+    {
+        const std::optional<Split> split{insert(root, levels, key, value)};
+        if (!split)
+            return;
+        // the root was split, so the tree grows a level
+        Inner &new_root{new_inner()};
+        new_root.count = 1;
+        new_root.keys[0] = split->separator;
+        new_root.children[0] = root;
+        new_root.children[1] = split->new_node;
+        root = inners.size() - 1;
+        ++levels;
+    }
+
+    void set(const Item &item)
+    {
+        set(std::get<0>(item), std::get<1>(item));
+    }
+
+    std::optional<Value> get(const Key &key) const
+    {
+        const Leaf &leaf{leaves[find_leaf(key)]};
+        const uint32_t position(std::lower_bound(leaf.keys.begin(), leaf.keys.begin() + leaf.count, key) - leaf.keys.begin());
+        if (position == leaf.count || key < leaf.keys[position])
+            return std::nullopt;
+        return leaf.values[position];
+    }
+
+    Value get(const Key &key, const Value &default_value) const
+    {
+        return get(key).value_or(default_value);
+    }
+
+    std::optional<Value> operator[](const Key &key) const
+    {
+        return get(key);
+    }
+
+    bool contains(const Key &key) const
+    {
+        return get(key).has_value();
+    }
+
+    // the first item with a key not less than key
+    iterator lower_bound(const Key &key) const
+    {
+        const int32_t leaf_idx{find_leaf(key)};
+        const Leaf &leaf{leaves[leaf_idx]};
+        return Iterator(this, leaf_idx, std::lower_bound(leaf.keys.begin(), leaf.keys.begin() + leaf.count, key) - leaf.keys.begin());
+    }
+
+    // the first item with a key greater than key
+    iterator upper_bound(const Key &key) const
+    {
+        const int32_t leaf_idx{find_leaf(key)};
+        const Leaf &leaf{leaves[leaf_idx]};
+        return Iterator(this, leaf_idx, std::upper_bound(leaf.keys.begin(), leaf.keys.begin() + leaf.count, key) - leaf.keys.begin());
+    }
+
+    // the items with keys in [low, high), in order
+    std::ranges::subrange<iterator> range(const Key &low, const Key &high) const
+    {
+        if (!(low < high))
+            return {end(), end()};
+        return {lower_bound(low), lower_bound(high)};
+    }
+
+    // the leftmost leaf is always the first one created
+    iterator begin() const { return Iterator(this, 0, 0); }
+    iterator end() const { return Iterator(); }
+
+    std::vector<Item> items() const
+    {
+        std::vector<Item> result{};
+        result.reserve(num_items);
+        for (const Item &item : *this)
+            result.push_back(item);
+        return result;
+    }
+
+    size_t size() const { return num_items; }
+
+    // number of levels of inner nodes above the leaves
+    size_t height() const { return levels; }
+
+    explicit operator bool() const { return num_items > 0; }
+
+    friend bool operator==(const OrderedMap &left, const OrderedMap &right)
+    {
+        return left.size() == right.size() && std::ranges::equal(left, right);
+    }
+
+    friend bool operator!=(const OrderedMap &left, const OrderedMap &right) { return !(left == right); }
+
+private:
+    std::vector<Leaf> leaves;
+    std::vector<Inner> inners;
+    int32_t root;
+    size_t levels; // 0 when the root is a leaf
+    size_t num_items;
+
+    Leaf &new_leaf()
+    {
+        if (leaves.size() == static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+            throw std::length_error("OrderedMap is full");
+        return leaves.emplace_back();
+    }
+
+    Inner &new_inner()
+    {
+        if (inners.size() == static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+            throw std::length_error("OrderedMap is full");
+        return inners.emplace_back();
+    }
+
+    // which child of the inner node could hold key
+    static uint32_t child_position(const Inner &inner, const Key &key)
+    {
+        return std::upper_bound(inner.keys.begin(), inner.keys.begin() + inner.count, key) - inner.keys.begin();
+    }
+
+    int32_t find_leaf(const Key &key) const
+    {
+        int32_t node{root};
+        for (size_t level = levels; level > 0; --level)
+            node = inners[node].children[child_position(inners[node], key)];
+        return node;
+    }
+
+    // add the item to the subtree rooted at node, which has level levels of inner nodes
+    // returns the new sibling if node had to be split to make room
+    // nodes can be reallocated by the recursive call, so references to them aren't held across it
+    std::optional<Split> insert(const int32_t node, const size_t level, const Key &key, const Value &value)
+    {
+        if (level == 0)
+            return insert_into_leaf(node, key, value);
+        const uint32_t position{child_position(inners[node], key)};
+        const std::optional<Split> child_split{insert(inners[node].children[position], level - 1, key, value)};
+        if (!child_split)
+            return std::nullopt;
+        return insert_into_inner(node, position, child_split.value());
+    }
+
+    std::optional<Split> insert_into_leaf(const int32_t leaf_idx, const Key &key, const Value &value)
+    {
+        uint32_t position;
+        {
+            Leaf &leaf{leaves[leaf_idx]};
+            position = std::lower_bound(leaf.keys.begin(), leaf.keys.begin() + leaf.count, key) - leaf.keys.begin();
+            if (position < leaf.count && !(key < leaf.keys[position]))
+            {
+                leaf.values[position] = value;
+                return std::nullopt;
+            }
+            ++num_items;
+            if (leaf.count < NODE_CAPACITY)
+            {
+                insert_at(leaf, position, key, value);
+                return std::nullopt;
+            }
+        }
+
+        // split the full leaf, the new leaf goes after it in the linked list
+        // when appending to the end, the full leaf is left full, so ascending keys fill leaves completely
+        const uint32_t split_at{(position == NODE_CAPACITY) ? NODE_CAPACITY : NODE_CAPACITY / 2};
+        new_leaf();
+        const int32_t right_idx(leaves.size() - 1);
+        Leaf &left{leaves[leaf_idx]};
+        Leaf &right{leaves[right_idx]};
+        std::move(left.keys.begin() + split_at, left.keys.end(), right.keys.begin());
+        std::move(left.values.begin() + split_at, left.values.end(), right.values.begin());
+        right.count = NODE_CAPACITY - split_at;
+        left.count = split_at;
+        right.next = left.next;
+        left.next = right_idx;
+        if (position < split_at)
+            insert_at(left, position, key, value);
+        else
+            insert_at(right, position - split_at, key, value);
+        return Split{right.keys[0], right_idx};
+    }
+
+    // insert the split child's new sibling after the child at position
+    std::optional<Split> insert_into_inner(const int32_t inner_idx, const uint32_t position, const Split &child_split)
+    {
+        {
+            Inner &inner{inners[inner_idx]};
+            if (inner.count < NODE_CAPACITY)
+            {
+                std::move_backward(inner.keys.begin() + position, inner.keys.begin() + inner.count, inner.keys.begin() + inner.count + 1);
+                std::move_backward(inner.children.begin() + position + 1, inner.children.begin() + inner.count + 1, inner.children.begin() + inner.count + 2);
+                inner.keys[position] = child_split.separator;
+                inner.children[position + 1] = child_split.new_node;
+                ++inner.count;
+                return std::nullopt;
+            }
+        }
+
+        // lay out the keys and children with the new one included, then share them between the two nodes
+        std::array<Key, NODE_CAPACITY + 1> keys;
+        std::array<int32_t, NODE_CAPACITY + 2> children;
+        {
+            Inner &inner{inners[inner_idx]};
+            std::move(inner.keys.begin(), inner.keys.begin() + position, keys.begin());
+            keys[position] = child_split.separator;
+            std::move(inner.keys.begin() + position, inner.keys.end(), keys.begin() + position + 1);
+            std::copy(inner.children.begin(), inner.children.begin() + position + 1, children.begin());
+            children[position + 1] = child_split.new_node;
+            std::copy(inner.children.begin() + position + 1, inner.children.end(), children.begin() + position + 2);
+        }
+
+        // the middle key moves up to the parent, as with leaves appending keeps the left node full
+        const uint32_t middle{(position == NODE_CAPACITY) ? NODE_CAPACITY : (NODE_CAPACITY + 1) / 2};
+        new_inner();
+        const int32_t right_idx(inners.size() - 1);
+        Inner &left{inners[inner_idx]};
+        Inner &right{inners[right_idx]};
+        left.count = middle;
+        std::move(keys.begin(), keys.begin() + middle, left.keys.begin());
+        std::copy(children.begin(), children.begin() + middle + 1, left.children.begin());
+        right.count = NODE_CAPACITY - middle;
+        std::move(keys.begin() + middle + 1, keys.end(), right.keys.begin());
+        std::copy(children.begin() + middle + 1, children.end(), right.children.begin());
+        return Split{keys[middle], right_idx};
+    }
+
+    // insert into a leaf that has room
+    static void insert_at(Leaf &leaf, const uint32_t position, const Key &key, const Value &value)
+    {
+        std::move_backward(leaf.keys.begin() + position, leaf.keys.begin() + leaf.count, leaf.keys.begin() + leaf.count + 1);
+        std::move_backward(leaf.values.begin() + position, leaf.values.begin() + leaf.count, leaf.values.begin() + leaf.count + 1);
+        leaf.keys[position] = key;
+        leaf.values[position] = value;
+        ++leaf.count;
+    }
+};
+
+void test_ordered_map()
+{
+    OrderedMap<int, std::string> map{};
+    assert(!map);
+    ctest::assert_equal(map.size(), 0);
+    assert(map.begin() == map.end());
+
+    map.set(5, "five");
+    map.set(1, "one");
+    map.set(3, "three");
+    assert(map);
+    ctest::assert_equal(map.size(), 3);
+    ctest::assert_equal(map.get(3), "three");
+    ctest::assert_equal(map[1], "one");
+    assert(!map.get(2));
+    ctest::assert_equal(map.get(2, "default"), "default");
+    assert(map.contains(5));
+    assert(!map.contains(4));
+
+    map.set(3, "THREE");
+    ctest::assert_equal(map.size(), 3);
+    ctest::assert_equal(map[3], "THREE");
+    std::vector<std::tuple<int, std::string>> expected_items{{1, "one"}, {3, "THREE"}, {5, "five"}};
+    ctest::assert_equal(map.items(), expected_items);
+
+    OrderedMap<int, std::string> map2{{5, "five"}, {3, "THREE"}, {1, "one"}};
+    ctest::assert_equal(map, map2);
+    map2.set(7, "seven");
+    assert(map != map2);
+}
+
+void test_ordered_map_bounds()
+{
+    OrderedMap<int, int> map{};
+    for (const int key : itertools::range(0, 1000, 10))
+        map.set(key, key * 2);
+
+    ctest::assert_equal(map.lower_bound(20).key(), 20);
+    ctest::assert_equal(map.lower_bound(21).key(), 30);
+    ctest::assert_equal(map.upper_bound(20).key(), 30);
+    ctest::assert_equal(map.lower_bound(-5).key(), 0);
+    assert(map.lower_bound(991) == map.end());
+    assert(map.upper_bound(990) == map.end());
+    ctest::assert_equal(*map.lower_bound(500), std::make_tuple(500, 1000));
+
+    std::vector<int> keys_in_range{};
+    for (const auto &[key, value] : map.range(95, 140))
+        keys_in_range.push_back(key);
+    ctest::assert_equal(keys_in_range, std::vector<int>{100, 110, 120, 130});
+    assert(map.range(140, 95).empty());
+    assert(map.range(991, 2000).empty());
+    ctest::assert_equal(std::ranges::distance(map.range(-100, 2000)), 100);
+}
+
+void test_ordered_map_splits()
+{
+    // enough items for several levels of inner nodes, inserted in ascending, descending and random order
+    const int num_items{100000};
+    std::vector<int> ascending{itertools::range(0, num_items)};
+    std::vector<int> descending{itertools::range(num_items - 1, -1, -1)};
+    std::vector<int> shuffled{ascending};
+    std::ranges::shuffle(shuffled, std::mt19937{3});
+
+    for (const std::vector<int> &order : {ascending, descending, shuffled})
+    {
+        OrderedMap<int, int> map{};
+        for (const int key : order)
+            map.set(key, -key);
+        ctest::assert_equal(map.size(), num_items);
+        assert(map.height() >= 2);
+        int expected{0};
+        for (const auto &[key, value] : map)
+        {
+            ctest::assert_equal(key, expected);
+            ctest::assert_equal(value, -expected);
+            ++expected;
+        }
+        ctest::assert_equal(expected, num_items);
+        for (const int key : {0, 1, 777, num_items - 1})
+            ctest::assert_equal(map[key], -key);
+        assert(!map.contains(num_items));
+    }
+}
+
+void test_ordered_map_matches_std_map()
+{
+    std::mt19937 generator{11};
+    std::uniform_int_distribution<int> distribution{0, 5000};
+    OrderedMap<int, int> map{};
+    std::map<int, int> expected{};
+    for (int i = 0; i < 20000; ++i)
+    {
+        const int key{distribution(generator)};
+        map.set(key, i);
+        expected[key] = i;
+    }
+    ctest::assert_equal(map.size(), expected.size());
+    ctest::assert_equal(map.items(), std::vector<std::tuple<int, int>>(expected.begin(), expected.end()));
+    for (int key = -1; key <= 5001; ++key)
+    {
+        const auto expected_lower{expected.lower_bound(key)};
+        const auto lower{map.lower_bound(key)};
+        assert((expected_lower == expected.end()) == (lower == map.end()));
+        if (lower != map.end())
+            ctest::assert_equal(lower.key(), expected_lower->first);
+    }
+}
+
+void test_ordered_map_bulk_load()
+{
+    std::vector<std::tuple<int, std::string>> items{};
+    for (const int key : itertools::range(0, 5000))
+        items.emplace_back(key * 2, strlib::to_str(key));
+    OrderedMap<int, std::string> map{OrderedMap<int, std::string>::bulk_load(items)};
+    ctest::assert_equal(map.size(), 5000);
+    ctest::assert_equal(map.items(), items);
+    ctest::assert_equal(map[4000], "2000");
+    assert(!map.contains(4001));
+
+    // the bulk loaded tree can still be added to
+    map.set(4001, "odd");
+    map.set(-1, "first");
+    map.set(100000, "last");
+    ctest::assert_equal(map.size(), 5003);
+    ctest::assert_equal(map.lower_bound(4001).value(), "odd");
+    ctest::assert_equal(map.begin().value(), "first");
+    ctest::assert_equal(std::get<1>(map.items().back()), "last");
+
+    assert(!(OrderedMap<int, int>::bulk_load({})));
+    ctest::raises<std::invalid_argument>([]()
+                                         { OrderedMap<int, int>::bulk_load({{2, 0}, {1, 0}}); });
+    ctest::raises<std::invalid_argument>([]()
+                                         { OrderedMap<int, int>::bulk_load({{1, 0}, {1, 0}}); });
+}
+
+void benchmark_ordered_map()
+{
+    // time ordered keys, then scans over ranges of them
+    const int num_items{1 << 20};
+    OrderedMap<long, long> map{};
+    std::map<long, long> std_map{};
+    const double insert_seconds{ctest::time_it([&]()
+                                               { for (long key = 0; key < num_items; ++key) map.set(key, key); })};
+    const double std_insert_seconds{ctest::time_it([&]()
+                                                   { for (long key = 0; key < num_items; ++key) std_map.emplace_hint(std_map.end(), key, key); })};
+
+    long total{0};
+    long std_total{0};
+    const double scan_seconds{ctest::time_it([&]()
+                                             { for (long start = 0; start < num_items; start += 4096)
+                                                   for (const auto &[key, value] : map.range(start, start + 1024))
+                                                       total += value; })};
+    const double std_scan_seconds{ctest::time_it([&]()
+                                                 { for (long start = 0; start < num_items; start += 4096)
+                                                   {
+                                                       // find the end once, like range does, so each step is only an iterator increment
+                                                       const auto stop{std_map.lower_bound(start + 1024)};
+                                                       for (auto iter = std_map.lower_bound(start); iter != stop; ++iter)
+                                                           std_total += iter->second;
+                                                   } })};
+    ctest::assert_equal(total, std_total);
+
+    std::cout << "ns per item: insert " << insert_seconds * 1e9 / num_items << " (std::map " << std_insert_seconds * 1e9 / num_items
+              << "), range scan " << scan_seconds * 1e9 / (num_items / 4) << " (std::map " << std_scan_seconds * 1e9 / (num_items / 4) << ")" << std::endl;
+}
+
+int main()
+{
+    test_ordered_map();
+    test_ordered_map_bounds();
+    test_ordered_map_splits();
+    test_ordered_map_matches_std_map();
+    test_ordered_map_bulk_load();
+    benchmark_ordered_map();
+}
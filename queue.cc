@@ -2,16 +2,21 @@
 #include <exception>
 #include <iostream>
 #include <optional>
+#include <memory>
+#include <memory_resource>
 #include "itertools.h"
+#include "arena.h"
 #include "ctest.h"
 
 // Deliberately implemented without smart pointers to practice RAII with pointers
+// The array is allocated from a memory resource (the default heap if none is given), which must outlive the queue
 template <typename T>
 class Queue
 {
 public:
-    Queue(const int capacity = 128)
-        : values_ptr{new T[capacity]},
+    Queue(const int capacity = 128, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : memory{resource},
+          values_ptr{allocate(resource, capacity)},
           queue_start_offset{0},
           queue_end_offset{0},
           array_end_offset{capacity} {};
@@ -24,8 +29,10 @@ public:
 
     // Copy another queue, ignoring all lazily removed items
     // copies the capacity of the other queue by default, can also increase capacity if specified
-    Queue(const Queue &other, const std::optional<int> capacity = std::nullopt)
-        : Queue(capacity.value_or(other.array_end_offset))
+    // like the std::pmr containers, the copy uses the default resource unless one is given
+    Queue(const Queue &other, const std::optional<int> capacity = std::nullopt,
+          std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : Queue(capacity.value_or(other.array_end_offset), resource)
     {
         if (capacity.value_or(other.array_end_offset) < other.capacity())
             throw std::length_error("Cannot copy a queue to another queue with smaller capacity");
@@ -38,14 +45,20 @@ public:
     Queue<T> &operator=(const Queue<T> &other)
     {
         // copy other into a temporary, then swap, so that the temporary variable's destructor deallocates this->values_ptr
-        Queue(other).swap(*this);
+        // the copy uses this queue's resource, so assigning doesn't change where the queue allocates from
+        Queue(other, std::nullopt, memory).swap(*this);
         return *this;
     }
 
+    // other's array is taken along with its resource
     Queue(Queue &&other)
+        : memory{other.memory},
+          values_ptr{nullptr}, // so other's destructor is called on a nullptr after the swap
+          queue_start_offset{0},
+          queue_end_offset{0},
+          array_end_offset{0}
     {
         other.swap(*this);
-        other.values_ptr = nullptr; // so destructor is called on a nullptr, instead of un-initialised pointer
     }
 
     Queue<T> &operator=(Queue<T> &&other)
@@ -57,7 +70,11 @@ public:
 
     ~Queue()
     {
-        delete[] values_ptr;
+        if (values_ptr)
+        {
+            std::destroy_n(values_ptr, array_end_offset);
+            std::pmr::polymorphic_allocator<T>{memory}.deallocate(values_ptr, array_end_offset);
+        }
         values_ptr = nullptr;
     }
 
@@ -77,7 +94,10 @@ public:
 
     operator bool() const { return size() > 0; }
 
+    std::pmr::memory_resource *resource() const { return memory; }
+
 private:
+    std::pmr::memory_resource *memory;
     T *values_ptr;
     int queue_start_offset; // values_ptr + queue_start_offset == the first element in the queue
     int queue_end_offset;   // values_ptr + queue_end_offset == 1 past the last element in the queue
@@ -87,6 +107,7 @@ private:
     // then other goes out of scope, calling the destructor for the old variables in this
     void swap(Queue &other) noexcept
     {
+        std::swap(this->memory, other.memory);
         std::swap(this->values_ptr, other.values_ptr);
         std::swap(this->queue_start_offset, other.queue_start_offset);
         std::swap(this->queue_end_offset, other.queue_end_offset);
@@ -98,7 +119,15 @@ private:
     {
         // Create a new Queue with double the capacity using the copy constructor
         // the copy assignment then ensures that the old values in *this are deallocated by the destructor
-        Queue(*this, array_end_offset * 2).swap(*this);
+        Queue(*this, array_end_offset * 2, memory).swap(*this);
+    }
+
+    // like new T[capacity], but from resource
+    static T *allocate(std::pmr::memory_resource *resource, const int capacity)
+    {
+        T *const values{std::pmr::polymorphic_allocator<T>{resource}.allocate(capacity)};
+        std::uninitialized_default_construct_n(values, capacity);
+        return values;
     }
 };
 
@@ -211,6 +240,27 @@ void test_queue_bool()
     assert(Queue<int>{1});
 }
 
+void test_queue_memory_resource()
+{
+    arena::PoolResource pool{};
+    {
+        const ctest::ScopedDefaultResource no_default_allocations{std::pmr::null_memory_resource()};
+        Queue<int> queue(1, &pool);
+        for (const int i : itertools::range(0, 100))
+            queue.push_back(i);
+        ctest::assert_equal(queue.capacity(), 128);
+        ctest::assert_equal(queue.pop_head(), 0);
+        assert(queue.resource() == &pool);
+
+        // assigning keeps the queue's own resource
+        Queue<int> copy(1, &pool);
+        copy = queue;
+        assert(copy.resource() == &pool);
+        ctest::assert_equal(copy.size(), 99);
+        ctest::assert_equal(copy.pop_head(), 1);
+    }
+}
+
 int main()
 {
     test_queue();
@@ -219,4 +269,5 @@ int main()
     test_queue_copy_assignment();
     test_queue_move_assignment();
     test_queue_bool();
+    test_queue_memory_resource();
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <assert.h>
 #include <vector>
 #include "set.h"
+#include "intern.h"
 #include "ctest.h"
 
 void test_set_add()
@@ -81,6 +82,7 @@ void test_capacity_expansion()
     for (const int &i : long_vector)
         assert(set.contains(i));
     assert(set.capacity() > 1000);
+    ctest::assert_equal(set.size(), long_vector.size());
 }
 
 void test_set_union()
@@ -171,6 +173,45 @@ void test_set_insertion_order()
     ctest::assert_equal(set1.items(), std::vector{1000, -400, 2, 1});
 }
 
+void test_set_copy()
+{
+    Set<int> set{1, 2, 3};
+    Set<int> copy{set};
+    copy.remove(1);
+    copy.add(4);
+    set.add(5);
+    ctest::assert_equal(set.items(), std::vector<int>{1, 2, 3, 5});
+    ctest::assert_equal(copy.items(), std::vector<int>{2, 3, 4});
+    assert(copy.contains(4));
+    assert(!copy.contains(1));
+
+    Set<int> moved{std::move(copy)};
+    moved.remove(2);
+    ctest::assert_equal(moved.items(), std::vector<int>{3, 4});
+
+    // the moved from set is empty and can still be used
+    assert(!copy);
+    assert(!copy.contains(3));
+    copy.remove(3);
+    for (int i = 0; i < 20; ++i)
+        copy.add(i);
+    ctest::assert_equal(copy.size(), 20);
+    assert(copy.contains(19));
+    ctest::assert_equal(moved.items(), std::vector<int>{3, 4});
+}
+
+void test_set_interned_strings()
+{
+    strlib::InternPool pool{};
+    Set<strlib::InternedString> set{};
+    for (const std::string_view word : strlib::tokenize("the cat and the dog and the bird"))
+        set.add(pool.intern(word));
+    ctest::assert_equal(set.size(), 5);
+    assert(set.contains(pool.intern("dog")));
+    assert(!set.contains(pool.intern("fish")));
+    ctest::assert_outstream(set, "{ the cat and dog bird }");
+}
+
 int main()
 {
     test_set_add();
@@ -188,4 +229,6 @@ int main()
     test_set_equality();
     test_set_key_func();
     test_set_insertion_order();
+    test_set_copy();
+    test_set_interned_strings();
 }
\ No newline at end of file
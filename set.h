@@ -3,6 +3,7 @@
 
 #include <assert.h>
 #include <vector>
+#include <memory_resource>
 #include <iostream>
 #include <functional>
 #include <ranges>
@@ -10,13 +11,17 @@
 #include <optional>
 #include <concepts>
 #include "doubly_linked_list.h"
+#include "small_vector.h"
 #include "itertools.h"
 #include "functools.h"
 #include "concepts.h"
+#include "strlib.h"
 
 namespace set
 {
     constexpr int HASHSET_INITIAL_SIZE{8};
+    // nodes a bucket holds before allocating, the set grows when it has as many items as buckets so most hold 0-2
+    constexpr size_t BUCKET_INLINE_SIZE{2};
 }
 
 template <Hashable HashType, typename ValueType = HashType>
@@ -26,15 +31,17 @@ public:
     typedef ValueType value_type;
     typedef const ValueType *const_iterator;
     typedef DoubleNode<ValueType> Node;
-    typedef std::vector<std::shared_ptr<Node>> CacheSet;
+    typedef SmallVector<Node *, set::BUCKET_INLINE_SIZE, std::pmr::polymorphic_allocator<Node *>> CacheSet;
 
+    // the buckets and nodes are allocated from resource, which must outlive the set
     constexpr Set(
         const std::function<HashType(ValueType)> key_func = std::identity(),
-        const size_t &size = set::HASHSET_INITIAL_SIZE)
+        const size_t &size = set::HASHSET_INITIAL_SIZE,
+        std::pmr::memory_resource *resource = std::pmr::get_default_resource())
         : hasher{std::hash<HashType>()},
           key_func{key_func},
-          set_values{std::vector<CacheSet>(size)},
-          linked_list{},
+          set_values(size, resource),
+          linked_list{resource},
           vec_capacity{size} {};
 
     template <std::ranges::input_range Iter>
@@ -42,7 +49,8 @@ public:
     constexpr Set(
         const Iter &items,
         const std::function<HashType(ValueType)> key_func = std::identity(),
-        size_t const &size = set::HASHSET_INITIAL_SIZE) : Set(key_func, size)
+        size_t const &size = set::HASHSET_INITIAL_SIZE,
+        std::pmr::memory_resource *resource = std::pmr::get_default_resource()) : Set(key_func, size, resource)
     {
         add(items.begin(), items.end());
     }
@@ -50,11 +58,34 @@ public:
     constexpr Set(
         std::initializer_list<ValueType> items,
         const std::function<HashType(ValueType)> key_func = std::identity(),
-        size_t const &size = set::HASHSET_INITIAL_SIZE) : Set(key_func, size)
+        size_t const &size = set::HASHSET_INITIAL_SIZE,
+        std::pmr::memory_resource *resource = std::pmr::get_default_resource()) : Set(key_func, size, resource)
     {
         add(items.begin(), items.end());
     };
 
+    // the buckets point at nodes in the linked list, so a copy has to fill its own buckets
+    // like the std::pmr containers, the copy uses the default resource
+    Set(const Set &other) : Set(other.key_func, other.vec_capacity)
+    {
+        std::vector<ValueType> all_items{other.items()};
+        add(all_items.begin(), all_items.end());
+    }
+
+    // moving the linked list keeps its nodes where they are, so the buckets can be moved as they are
+    // other is left as an empty set with the initial capacity, so it can still be used
+    Set(Set &&other)
+        : hasher{other.hasher},
+          key_func{other.key_func},
+          vec_capacity{other.vec_capacity},
+          set_values(std::move(other.set_values)),
+          linked_list{std::move(other.linked_list)}
+    {
+        other.vec_capacity = set::HASHSET_INITIAL_SIZE;
+        other.set_values.clear();
+        other.set_values.resize(other.vec_capacity);
+    }
+
     size_t size() const
     {
         return linked_list.size();
@@ -65,6 +96,11 @@ public:
         return vec_capacity;
     }
 
+    std::pmr::memory_resource *resource() const
+    {
+        return linked_list.resource();
+    }
+
     bool contains(const ValueType item) const
     {
         return bool(find_node(item));
@@ -83,7 +119,7 @@ public:
     void set(const HashType key, const ValueType to_insert)
     {
         CacheSet &cache_set{set_values[hash_key(key)]};
-        std::shared_ptr<Node> to_remove{find_node(key, cache_set)};
+        Node *to_remove{find_node(key, cache_set)};
         _remove(cache_set, to_remove);
         _add(cache_set, to_insert);
     }
@@ -99,7 +135,7 @@ public:
     void remove(const ValueType &item)
     {
         CacheSet &cache_set{set_values[hash(item)]};
-        std::shared_ptr<Node> to_remove{find_node(item, cache_set)};
+        Node *to_remove{find_node(item, cache_set)};
         _remove(cache_set, to_remove);
     }
 
@@ -107,7 +143,7 @@ public:
     std::optional<ValueType> get(const HashType key) const
     {
         const CacheSet &cache_set{set_values[hash_key(key)]};
-        std::shared_ptr<Node> found_ptr{find_node(key, cache_set)};
+        Node *found_ptr{find_node(key, cache_set)};
         if (found_ptr)
             return found_ptr->item;
         return std::nullopt;
@@ -118,7 +154,14 @@ public:
         return linked_list.items();
     }
 
-    operator bool() const
+    // call func on every item in insertion order, without copying them
+    template <typename Func>
+    void for_each(const Func &func) const
+    {
+        linked_list.for_each(func);
+    }
+
+    explicit operator bool() const
     {
         return linked_list.size() > 0;
     }
@@ -129,52 +172,52 @@ private:
 
     // vector where vector[hash] is a vector containing all elements with that hash
     size_t vec_capacity;
-    std::vector<CacheSet> set_values;
+    std::pmr::vector<CacheSet> set_values; // each bucket gets the vector's resource too
     LinkedList<ValueType> linked_list;
 
     // find the node storing this item
-    std::shared_ptr<Node> find_node(const ValueType item) const
+    Node *find_node(const ValueType item) const
     {
         return find_node(item, set_values[hash(item)]);
     }
 
-    std::shared_ptr<Node> find_node(const ValueType item, const CacheSet &cache_set) const
+    Node *find_node(const ValueType item, const CacheSet &cache_set) const
     {
-        auto opt_shared_ptr{functools::find([item](const std::shared_ptr<Node> node)
+        auto opt_node{functools::find([item](const Node *node)
                                             { return node->item == item; },
                                             cache_set)};
-        if (opt_shared_ptr)
-            return opt_shared_ptr.value();
+        if (opt_node)
+            return opt_node.value();
         return nullptr;
     }
 
-    std::shared_ptr<Node> find_node(const HashType key, const CacheSet &cache_set) const
+    Node *find_node(const HashType key, const CacheSet &cache_set) const
         // only call this func when HashType is different
         // this requires clause ensures we don't have overlapping overloaded functions
         requires(!std::same_as<ValueType, HashType>)
     {
-        auto opt_shared_ptr{
-            functools::find([key, this](const std::shared_ptr<Node> node)
+        auto opt_node{
+            functools::find([key, this](const Node *node)
                             { return key_func(node->item) == key; },
                             cache_set)};
-        if (opt_shared_ptr)
-            return opt_shared_ptr.value();
+        if (opt_node)
+            return opt_node.value();
         return nullptr;
     }
 
     void _add(CacheSet &cache_set, const ValueType item)
     {
-        std::shared_ptr<Node> node_ptr{linked_list.add_and_track(item)};
+        Node *node_ptr{linked_list.add_and_track(item)};
         cache_set.push_back(node_ptr);
         if (size() == vec_capacity)
             expand_capacity();
     }
 
-    void _remove(CacheSet &cache_set, const std::shared_ptr<Node> to_remove)
+    void _remove(CacheSet &cache_set, Node *to_remove)
     {
         if (!to_remove)
             return;
-        std::erase(cache_set, to_remove);
+        cache_set.erase(std::find(cache_set.begin(), cache_set.end(), to_remove));
         linked_list.remove(to_remove);
     }
 
@@ -185,6 +228,7 @@ private:
         std::vector<ValueType> all_items{items()};
         set_values.clear();
         set_values.resize(vec_capacity);
+        linked_list.clear(); // the items are added back, so the old nodes have to go
         add(all_items.begin(), all_items.end());
     }
 
@@ -257,18 +301,24 @@ std::ostream &operator<<(std::ostream &os, const Set<T> &set)
 {
     os << "{ ";
     for (const T &item : set.items())
-        os << item << " ";
+    {
+        __strlib_utils::write_value(os, item);
+        os << " ";
+    }
     os << "}";
     return os;
 }
 
-template <typename T>
-bool operator==(const Set<T> &left, const Set<T> &right)
+template <typename HashType, typename ValueType>
+bool operator==(const Set<HashType, ValueType> &left, const Set<HashType, ValueType> &right)
 {
-    return left.size() == right.size() && set::is_subset(left, right) && set::is_subset(right, left);
+    // with equal sizes, left being a subset of right implies the sets are equal
+    auto in_right{[&right](const ValueType &item)
+                  { return right.contains(item); }};
+    return left.size() == right.size() && functools::all(in_right, left.items());
 }
 
-template <typename T>
-bool operator!=(const Set<T> &left, const Set<T> &right) { return !(left == right); }
+template <typename HashType, typename ValueType>
+bool operator!=(const Set<HashType, ValueType> &left, const Set<HashType, ValueType> &right) { return !(left == right); }
 
 #endif
@@ -0,0 +1,177 @@
+#include <assert.h>
+#include <vector>
+#include <random>
+#include <iterator>
+#include "skip_list.h"
+#include "doubly_linked_list.h"
+#include "ctest.h"
+
+void test_skip_list_add()
+{
+    SkipList<int> list;
+    list.add(1);
+    ctest::assert_equal(list.back(), 1);
+    ctest::assert_equal(list.size(), 1);
+    ctest::assert_equal(list.items(), std::vector<int>{1});
+    list.add(5);
+    ctest::assert_equal(list.back(), 5);
+    ctest::assert_equal(list.size(), 2);
+    ctest::assert_equal(list.items(), std::vector<int>{1, 5});
+}
+
+void test_skip_list_access()
+{
+    SkipList<int> list{1, 2, 3, 4};
+    ctest::assert_equal(list.size(), 4);
+    ctest::assert_equal(list[0], 1);
+    ctest::assert_equal(list[1], 2);
+    ctest::assert_equal(list[2], 3);
+    ctest::assert_equal(list[3], 4);
+    list[2] = 30;
+    ctest::assert_equal(list.items(), std::vector<int>{1, 2, 30, 4});
+    ctest::raises<std::range_error>([&list]()
+                                    { list[-1]; },
+                                    "Invalid index -1, must be between 0 and 4");
+}
+
+void test_skip_list_insert()
+{
+    SkipList<int> list{1, 2, 3, 4};
+    list.insert(0, 10);
+    ctest::assert_equal(list.items(), std::vector<int>{10, 1, 2, 3, 4});
+
+    list.insert(2, 5);
+    ctest::assert_equal(list.items(), std::vector<int>{10, 1, 5, 2, 3, 4});
+    ctest::assert_equal(list.back(), 4);
+
+    // like LinkedList, insert can't insert at the end of the list (add should be used instead)
+    ctest::raises([&list]()
+                  { list.insert(6, 10); });
+}
+
+void test_skip_list_remove()
+{
+    SkipList<int> list{1, 2, 3, 4};
+    list.remove(0);
+    ctest::assert_equal(list.items(), std::vector<int>{2, 3, 4});
+
+    list.remove(1);
+    ctest::assert_equal(list.items(), std::vector<int>{2, 4});
+
+    SkipList<int> one_item{1};
+    one_item.remove(0);
+    ctest::assert_equal(one_item.items(), std::vector<int>{});
+    assert(!one_item);
+
+    // the back is updated when removing the last item
+    SkipList<int> list2{1, 2, 3, 4};
+    list2.remove(3);
+    ctest::assert_equal(list2.back(), 3);
+    list2.add(5);
+    ctest::assert_equal(list2.items(), std::vector<int>{1, 2, 3, 5});
+}
+
+void test_skip_list_iterator()
+{
+    SkipList<int> list{1, 2, 3, 4};
+    std::vector<int> extracted(list.begin(), list.end());
+    ctest::assert_equal(extracted, std::vector<int>{1, 2, 3, 4});
+
+    static_assert(std::forward_iterator<SkipList<int>::iterator>);
+    static_assert(std::forward_iterator<SkipList<int>::const_iterator>);
+    static_assert(std::ranges::forward_range<const SkipList<int>>);
+
+    *(++list.begin()) = 5;
+    ctest::assert_equal(list[1], 5);
+
+    std::vector<std::tuple<int, int>> enumerated{itertools::enumerate(list)};
+    std::vector<std::tuple<int, int>> expected_result{{0, 1}, {1, 5}, {2, 3}, {3, 4}};
+    ctest::assert_equal(enumerated, expected_result);
+}
+
+void test_skip_list_copy()
+{
+    SkipList<int> list{1, 2, 3};
+    SkipList<int> copy{list};
+    copy.insert(0, 0);
+    ctest::assert_equal(list.items(), std::vector<int>{1, 2, 3});
+    ctest::assert_equal(copy.items(), std::vector<int>{0, 1, 2, 3});
+
+    SkipList<int> moved{std::move(copy)};
+    ctest::assert_equal(moved.items(), std::vector<int>{0, 1, 2, 3});
+    assert(!copy);
+    copy.add(1);
+    ctest::assert_equal(copy.items(), std::vector<int>{1});
+}
+
+void test_skip_list_random()
+{
+    // random positional edits, checked against a vector
+    std::mt19937 generator{7};
+    SkipList<int> list{};
+    std::vector<int> expected{};
+    for (int i = 0; i < 50000; ++i)
+    {
+        const int op = generator() % 4;
+        if (op == 0 || expected.empty())
+        {
+            list.add(i);
+            expected.push_back(i);
+            continue;
+        }
+        const int index = generator() % expected.size();
+        if (op == 1)
+        {
+            list.insert(index, i);
+            expected.insert(expected.begin() + index, i);
+        }
+        else if (op == 2)
+        {
+            list.remove(index);
+            expected.erase(expected.begin() + index);
+        }
+        else
+            ctest::assert_equal(list[index], expected[index]);
+        if (!expected.empty())
+            ctest::assert_equal(list.back(), expected.back());
+    }
+    ctest::assert_equal(list.size(), static_cast<int>(expected.size()));
+    ctest::assert_equal(list.items(), expected);
+}
+
+// Per edit cost of inserting and removing at random positions, compared to LinkedList which walks to the position
+template <typename List>
+double time_positional_edits(const int num_items)
+{
+    std::mt19937 generator{1};
+    List list{};
+    for (int i = 0; i < num_items; ++i)
+        list.add(i);
+    const double seconds{ctest::time_it([&]()
+                                        { for (int i = 0; i < num_items; ++i)
+                                          {
+                                              list.insert(generator() % list.size(), i);
+                                              list.remove(generator() % list.size());
+                                          } })};
+    ctest::assert_equal(list.size(), num_items);
+    return seconds * 1e9 / (2 * num_items);
+}
+
+void benchmark_skip_list()
+{
+    std::cout << "ns per positional edit, 20000 items: skip list " << time_positional_edits<SkipList<int>>(20000)
+              << ", linked list " << time_positional_edits<LinkedList<int>>(20000) << std::endl;
+    std::cout << "ns per positional edit, 1000000 items: skip list " << time_positional_edits<SkipList<int>>(1000000) << std::endl;
+}
+
+int main()
+{
+    test_skip_list_add();
+    test_skip_list_access();
+    test_skip_list_insert();
+    test_skip_list_remove();
+    test_skip_list_iterator();
+    test_skip_list_copy();
+    test_skip_list_random();
+    benchmark_skip_list();
+}
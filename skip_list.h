@@ -0,0 +1,290 @@
+#ifndef CPP_LEARNING_SKIP_LIST
+#define CPP_LEARNING_SKIP_LIST
+
+#include <array>
+#include <vector>
+#include <random>
+#include <bit>
+#include <algorithm>
+#include <iterator>
+#include <initializer_list>
+#include <cstdint>
+#include <assert.h>
+#include "itertools.h"
+
+namespace skip_list
+{
+    // each level has a quarter of the nodes of the level below, so 16 levels handle billions of items
+    constexpr int MAX_HEIGHT{16};
+}
+
+// List with the same API as LinkedList, where getting, inserting and removing by index are O(log n)
+// Each node is linked into a random number of levels, and each link records how many positions it skips,
+// so finding an index follows the long links at the top and drops down a level whenever they would overshoot
+template <typename T>
+class SkipList
+{
+    static constexpr int MAX_HEIGHT{skip_list::MAX_HEIGHT};
+    static constexpr int32_t NO_NODE{-1};
+    static constexpr int32_t HEAD{0}; // node before the first item, linked into every level
+
+    struct Node
+    {
+        T item;
+        int32_t first_link; // the node's links are links[first_link:first_link + height]
+        int32_t height;
+    };
+
+    struct Link
+    {
+        int32_t next;
+        int32_t width; // positions between the node and next, where the end of the list is the position after the last item
+    };
+
+    template <typename List>
+    struct BaseIterator
+    {
+    public:
+        typedef T value_type;
+        typedef decltype((std::declval<List &>().nodes[0].item)) reference;
+        typedef std::ptrdiff_t difference_type;
+        typedef std::forward_iterator_tag iterator_category;
+
+        BaseIterator() : list{nullptr}, node{NO_NODE} {}
+
+        BaseIterator(List *list, const int32_t node) : list{list}, node{node} {}
+
+        reference operator*() const { return list->nodes[node].item; }
+        auto operator->() const { return &list->nodes[node].item; }
+        BaseIterator &operator++()
+        {
+            node = list->link(node, 0).next;
+            return *this;
+        }
+        BaseIterator operator++(int)
+        {
+            BaseIterator temp = *this;
+            ++*this;
+            return temp;
+        }
+        friend bool operator==(const BaseIterator &iter1, const BaseIterator &iter2) { return iter1.node == iter2.node; }
+        friend bool operator!=(const BaseIterator &iter1, const BaseIterator &iter2) { return !(iter1 == iter2); }
+
+    private:
+        List *list;
+        int32_t node;
+    };
+
+public:
+    using value_type = T;
+    using iterator = BaseIterator<SkipList>;
+    using const_iterator = BaseIterator<const SkipList>;
+
+    SkipList() : nodes{}, links(MAX_HEIGHT, Link{NO_NODE, 1}), free_nodes{}, levels{1}, last{HEAD}, length{0}, generator{}
+    {
+        nodes.push_back(Node{T{}, 0, MAX_HEIGHT});
+    }
+
+    SkipList(const std::initializer_list<T> &items) : SkipList()
+    {
+        for (const T &item : items)
+            add(item);
+    }
+
+    SkipList(const SkipList &other) = default;
+
+    // the moved from list is left empty, it still needs its head node
+    SkipList(SkipList &&other) : SkipList() { other.swap(*this); }
+
+    SkipList &operator=(const SkipList &other)
+    {
+        SkipList(other).swap(*this);
+        return *this;
+    }
+
+    SkipList &operator=(SkipList &&other)
+    {
+        SkipList(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    // add item to the end of the list, O(log n)
+    void add(const T &item) { insert_at(length, item); }
+
+    // insert item so that it becomes the item at index, and moves the following items up, O(log n)
+    void insert(const int index, const T &item)
+    {
+        itertools::validate_index(index, length);
+        insert_at(index, item);
+    }
+
+    // remove the item at index, O(log n)
+    void remove(const int index)
+    {
+        itertools::validate_index(index, length);
+        std::array<int32_t, MAX_HEIGHT> before;
+        std::array<int, MAX_HEIGHT> before_positions;
+        find_before(index, before, before_positions);
+
+        const int32_t node{link(before[0], 0).next};
+        const int32_t height{nodes[node].height};
+        for (int level = 0; level < MAX_HEIGHT; ++level)
+        {
+            Link &before_link{link(before[level], level)};
+            if (level < height)
+                before_link = Link{link(node, level).next, before_link.width + link(node, level).width - 1};
+            else
+                --before_link.width;
+        }
+        while (levels > 1 && link(HEAD, levels - 1).next == NO_NODE)
+            --levels;
+        if (node == last)
+            last = before[0];
+
+        nodes[node].item = T{};
+        free_nodes[height].push_back(node);
+        --length;
+    }
+
+    T back() const { return nodes[last].item; }
+
+    // get item, O(log n)
+    T &operator[](const int index)
+    {
+        itertools::validate_index(index, length);
+        return nodes[find(index)].item;
+    }
+
+    const T &operator[](const int index) const
+    {
+        itertools::validate_index(index, length);
+        return nodes[find(index)].item;
+    }
+
+    std::vector<T> items() const { return std::vector<T>(begin(), end()); }
+
+    int size() const { return length; }
+
+    explicit operator bool() const { return length > 0; }
+
+    iterator begin() { return iterator(this, link(HEAD, 0).next); }
+
+    iterator end() { return iterator(this, NO_NODE); }
+
+    const_iterator begin() const { return const_iterator(this, link(HEAD, 0).next); }
+
+    const_iterator end() const { return const_iterator(this, NO_NODE); }
+
+    void swap(SkipList &other) noexcept
+    {
+        std::swap(this->nodes, other.nodes);
+        std::swap(this->links, other.links);
+        std::swap(this->free_nodes, other.free_nodes);
+        std::swap(this->levels, other.levels);
+        std::swap(this->last, other.last);
+        std::swap(this->length, other.length);
+        std::swap(this->generator, other.generator);
+    }
+
+private:
+    std::vector<Node> nodes;
+    std::vector<Link> links;
+    std::array<std::vector<int32_t>, MAX_HEIGHT + 1> free_nodes; // removed nodes by height, so their links can be reused
+    int levels;                                                  // levels that have links other than the head's link to the end
+    int32_t last;
+    int length;
+    std::minstd_rand generator;
+
+    Link &link(const int32_t node, const int level) { return links[nodes[node].first_link + level]; }
+
+    const Link &link(const int32_t node, const int level) const { return links[nodes[node].first_link + level]; }
+
+    // the node holding the item at index
+    int32_t find(const int index) const
+    {
+        // the head is at position 0, so the item at index is at position index + 1
+        const int position{index + 1};
+        int32_t node{HEAD};
+        int node_position{0};
+        for (int level = levels - 1; level >= 0; --level)
+        {
+            while (link(node, level).next != NO_NODE && node_position + link(node, level).width <= position)
+            {
+                node_position += link(node, level).width;
+                node = link(node, level).next;
+            }
+        }
+        assert(node_position == position);
+        return node;
+    }
+
+    // on each level, find the last node before the item at index, and that node's position
+    void find_before(const int index, std::array<int32_t, MAX_HEIGHT> &before, std::array<int, MAX_HEIGHT> &before_positions) const
+    {
+        int32_t node{HEAD};
+        int node_position{0};
+        for (int level = MAX_HEIGHT - 1; level >= 0; --level)
+        {
+            if (level < levels)
+            {
+                while (link(node, level).next != NO_NODE && node_position + link(node, level).width <= index)
+                {
+                    node_position += link(node, level).width;
+                    node = link(node, level).next;
+                }
+            }
+            before[level] = node;
+            before_positions[level] = node_position;
+        }
+    }
+
+    void insert_at(const int index, const T &item)
+    {
+        std::array<int32_t, MAX_HEIGHT> before;
+        std::array<int, MAX_HEIGHT> before_positions;
+        find_before(index, before, before_positions);
+
+        const int32_t height{random_height()};
+        const int32_t node{new_node(item, height)};
+        const int position{index + 1};
+        for (int level = 0; level < MAX_HEIGHT; ++level)
+        {
+            Link &before_link{link(before[level], level)};
+            if (level < height)
+            {
+                // the link from before is split in two around the new node, the item after it moves up a position
+                link(node, level) = Link{before_link.next, before_positions[level] + before_link.width - index};
+                before_link = Link{node, position - before_positions[level]};
+            }
+            else
+                ++before_link.width;
+        }
+        levels = std::max(levels, height);
+        if (index == length)
+            last = node;
+        ++length;
+    }
+
+    // heights 1, 2, 3, ... with probabilities 3/4, 3/16, 3/64, ...
+    int32_t random_height()
+    {
+        const uint32_t bits{static_cast<uint32_t>(generator()) | (1u << 30)};
+        return std::min<int32_t>(1 + std::countr_zero(bits) / 2, MAX_HEIGHT);
+    }
+
+    int32_t new_node(const T &item, const int32_t height)
+    {
+        if (!free_nodes[height].empty())
+        {
+            const int32_t node{free_nodes[height].back()};
+            free_nodes[height].pop_back();
+            nodes[node].item = item;
+            return node;
+        }
+        nodes.push_back(Node{item, static_cast<int32_t>(links.size()), height});
+        links.resize(links.size() + height);
+        return nodes.size() - 1;
+    }
+};
+
+#endif
@@ -0,0 +1,159 @@
+#include <assert.h>
+#include <vector>
+#include <string>
+#include <iterator>
+#include <memory_resource>
+#include "small_vector.h"
+#include "functools.h"
+#include "arena.h"
+#include "ctest.h"
+
+void test_small_vector_inline()
+{
+    SmallVector<int, 4> vect{};
+    assert(vect.empty());
+    for (int i = 0; i < 4; ++i)
+        vect.push_back(i);
+    assert(vect.is_inline());
+    ctest::assert_equal(vect.size(), 4);
+    ctest::assert_equal(vect.capacity(), 4);
+    ctest::assert_equal(std::vector<int>(vect.begin(), vect.end()), std::vector<int>{0, 1, 2, 3});
+
+    // growing past the inline storage moves the items to the heap
+    vect.push_back(4);
+    assert(!vect.is_inline());
+    ctest::assert_equal(vect.capacity(), 8);
+    ctest::assert_equal(vect.front(), 0);
+    ctest::assert_equal(vect.back(), 4);
+    vect.pop_back();
+    ctest::assert_equal(vect.back(), 3);
+    ctest::assert_equal(vect.size(), 4);
+    vect.clear();
+    assert(vect.empty());
+}
+
+void test_small_vector_strings()
+{
+    // items that own memory are constructed, moved and destroyed properly
+    SmallVector<std::string, 2> vect{};
+    for (int i = 0; i < 20; ++i)
+        vect.push_back(std::string(30, 'a' + i));
+    ctest::assert_equal(vect[19], std::string(30, 't'));
+
+    // pushing an item of the vector itself while it grows
+    SmallVector<std::string, 2> small{"first item, long enough to allocate", "second"};
+    small.push_back(small[0]);
+    ctest::assert_equal(small[2], std::string("first item, long enough to allocate"));
+    small.emplace_back(5, 'x');
+    ctest::assert_equal(small.back(), std::string("xxxxx"));
+}
+
+void test_small_vector_copy_move()
+{
+    const SmallVector<int, 2> small{1, 2};
+    const SmallVector<int, 2> large{1, 2, 3, 4};
+    for (const SmallVector<int, 2> &original : {small, large})
+    {
+        SmallVector<int, 2> copy{original};
+        assert(copy == original);
+        copy.push_back(10);
+        assert(!(copy == original));
+
+        SmallVector<int, 2> moved{std::move(copy)};
+        assert(copy.empty());
+        assert(copy.is_inline());
+        ctest::assert_equal(moved.back(), 10);
+
+        SmallVector<int, 2> assigned{5};
+        assigned = original;
+        assert(assigned == original);
+        assigned = std::move(moved);
+        ctest::assert_equal(assigned.size(), original.size() + 1);
+    }
+}
+
+void test_small_vector_erase()
+{
+    SmallVector<int, 2> vect{1, 2, 3, 4};
+    ctest::assert_equal(*vect.erase(vect.begin() + 1), 3);
+    ctest::assert_equal(std::vector<int>(vect.begin(), vect.end()), std::vector<int>{1, 3, 4});
+    vect.erase(vect.end() - 1);
+    ctest::assert_equal(std::vector<int>(vect.begin(), vect.end()), std::vector<int>{1, 3});
+}
+
+void test_small_vector_range()
+{
+    static_assert(std::contiguous_iterator<SmallVector<int, 2>::iterator>);
+    static_assert(std::ranges::contiguous_range<const SmallVector<int, 2>>);
+    SmallVector<int, 2> vect{1, 2, 3};
+    ctest::assert_outstream(vect, "[ 1 2 3 ]");
+    ctest::assert_equal(functools::find([](const int item)
+                                        { return item > 1; },
+                                        vect),
+                        2);
+    assert(!functools::find([](const int item)
+                            { return item > 3; },
+                            vect));
+}
+
+void test_small_vector_allocator()
+{
+    using PmrSmallVector = SmallVector<int, 2, std::pmr::polymorphic_allocator<int>>;
+    arena::PoolResource pool1{}, pool2{};
+    PmrSmallVector vect{{1, 2, 3, 4}, &pool1};
+    assert(!vect.is_inline());
+    assert(vect.get_allocator().resource() == &pool1);
+
+    // moving to the same resource takes the heap allocation, to another resource moves the items
+    const int *const items{vect.data()};
+    PmrSmallVector same{std::move(vect), &pool1};
+    ctest::assert_equal(same.data(), items);
+    PmrSmallVector other{std::move(same), &pool2};
+    assert(other.data() != items);
+    assert(other.get_allocator().resource() == &pool2);
+    ctest::assert_equal(other.back(), 4);
+
+    // assigning keeps the vector's own resource
+    PmrSmallVector assigned{&pool1};
+    assigned = std::move(other);
+    assert(assigned.get_allocator().resource() == &pool1);
+    ctest::assert_equal(assigned.size(), 4);
+}
+
+// Per vector cost of building many short vectors, compared to std::vector
+void benchmark_small_vector()
+{
+    const int num_vectors{1000000};
+    long small_total{0};
+    const double small_seconds{ctest::time_it([&small_total]()
+                                              { for (int i = 0; i < num_vectors; ++i)
+                                                {
+                                                    SmallVector<int, 4> vect{};
+                                                    for (int j = 0; j < i % 4; ++j)
+                                                        vect.push_back(j);
+                                                    small_total += vect.size();
+                                                } })};
+    long std_total{0};
+    const double std_seconds{ctest::time_it([&std_total]()
+                                            { for (int i = 0; i < num_vectors; ++i)
+                                              {
+                                                  std::vector<int> vect{};
+                                                  for (int j = 0; j < i % 4; ++j)
+                                                      vect.push_back(j);
+                                                  std_total += vect.size();
+                                              } })};
+    ctest::assert_equal(small_total, std_total);
+    std::cout << "ns per short vector: small vector " << small_seconds * 1e9 / num_vectors
+              << ", std::vector " << std_seconds * 1e9 / num_vectors << std::endl;
+}
+
+int main()
+{
+    test_small_vector_inline();
+    test_small_vector_strings();
+    test_small_vector_copy_move();
+    test_small_vector_erase();
+    test_small_vector_range();
+    test_small_vector_allocator();
+    benchmark_small_vector();
+}
@@ -0,0 +1,246 @@
+#ifndef CPP_LEARNING_SMALL_VECTOR
+#define CPP_LEARNING_SMALL_VECTOR
+
+#include <memory>
+#include <new>
+#include <algorithm>
+#include <initializer_list>
+#include <iostream>
+#include <utility>
+#include <cstddef>
+#include <assert.h>
+#include "strlib.h"
+
+// Vector that stores its first N items inside itself, and only allocates once it grows past them
+// Suited to the many short vectors that are usually empty or hold a couple of items, like hash buckets
+// Unlike std::vector, moving a small vector moves its items, so iterators and pointers to them are invalidated
+// Like the standard containers it takes an allocator, so std::pmr::polymorphic_allocator can put it in an arena
+template <typename T, size_t N, typename Allocator = std::allocator<T>>
+class SmallVector
+{
+    static_assert(N > 0, "use std::vector when there is no inline storage");
+    using AllocatorTraits = std::allocator_traits<Allocator>;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    SmallVector() : SmallVector(Allocator()) {}
+
+    explicit SmallVector(const Allocator &allocator) : allocator{allocator}, heap{nullptr}, length{0}, allocated{N} {}
+
+    SmallVector(const std::initializer_list<T> &items, const Allocator &allocator = Allocator()) : SmallVector(allocator)
+    {
+        reserve(items.size());
+        for (const T &item : items)
+            emplace_back(item);
+    }
+
+    SmallVector(const SmallVector &other)
+        : SmallVector(AllocatorTraits::select_on_container_copy_construction(other.allocator)) { copy(other); }
+
+    SmallVector(const SmallVector &other, const Allocator &allocator) : SmallVector(allocator) { copy(other); }
+
+    SmallVector(SmallVector &&other) noexcept : SmallVector(other.allocator) { take(other); }
+
+    // taking over a heap allocation needs the same allocator, otherwise the items are moved one by one
+    SmallVector(SmallVector &&other, const Allocator &allocator) : SmallVector(allocator)
+    {
+        if (other.heap && allocator != other.allocator)
+        {
+            copy_moved(other);
+            other.clear();
+        }
+        else
+            take(other);
+    }
+
+    SmallVector &operator=(const SmallVector &other)
+    {
+        if (this != &other)
+        {
+            clear();
+            copy(other);
+        }
+        return *this;
+    }
+
+    // the allocator stays the same (polymorphic allocators don't propagate), so other's heap is only taken if they match
+    SmallVector &operator=(SmallVector &&other) noexcept(AllocatorTraits::is_always_equal::value)
+    {
+        if (this == &other)
+            return *this;
+        clear();
+        if (other.heap && allocator != other.allocator)
+        {
+            copy_moved(other);
+            other.clear();
+        }
+        else
+        {
+            free_heap();
+            take(other);
+        }
+        return *this;
+    }
+
+    ~SmallVector()
+    {
+        clear();
+        free_heap();
+    }
+
+    void push_back(const T &item) { emplace_back(item); }
+
+    void push_back(T &&item) { emplace_back(std::move(item)); }
+
+    template <typename... Args>
+    T &emplace_back(Args &&...args)
+    {
+        if (length == allocated)
+        {
+            // construct the new item before moving the old ones, in case args refer to one of them
+            const size_t new_allocated{2 * allocated};
+            T *const new_items{AllocatorTraits::allocate(allocator, new_allocated)};
+            AllocatorTraits::construct(allocator, new_items + length, std::forward<Args>(args)...);
+            move_to(new_items, new_allocated);
+        }
+        else
+            AllocatorTraits::construct(allocator, data() + length, std::forward<Args>(args)...);
+        return data()[length++];
+    }
+
+    void pop_back()
+    {
+        assert(length > 0);
+        AllocatorTraits::destroy(allocator, data() + --length);
+    }
+
+    // remove the item at position, moving the following items down
+    iterator erase(const_iterator position)
+    {
+        T *const item{data() + (position - data())};
+        std::move(item + 1, end(), item);
+        pop_back();
+        return item;
+    }
+
+    void clear()
+    {
+        for (T &item : *this)
+            AllocatorTraits::destroy(allocator, &item);
+        length = 0;
+    }
+
+    void reserve(const size_t capacity)
+    {
+        if (capacity > allocated)
+            move_to(AllocatorTraits::allocate(allocator, capacity), capacity);
+    }
+
+    T &operator[](const size_t index) { return data()[index]; }
+    const T &operator[](const size_t index) const { return data()[index]; }
+
+    T &front() { return data()[0]; }
+    const T &front() const { return data()[0]; }
+    T &back() { return data()[length - 1]; }
+    const T &back() const { return data()[length - 1]; }
+
+    T *data() { return (heap) ? heap : std::launder(reinterpret_cast<T *>(storage)); }
+    const T *data() const { return (heap) ? heap : std::launder(reinterpret_cast<const T *>(storage)); }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + length; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + length; }
+
+    size_t size() const { return length; }
+
+    size_t capacity() const { return allocated; }
+
+    bool empty() const { return length == 0; }
+
+    // true if the items are stored inline
+    bool is_inline() const { return heap == nullptr; }
+
+    Allocator get_allocator() const { return allocator; }
+
+    friend bool operator==(const SmallVector &left, const SmallVector &right)
+    {
+        return std::equal(left.begin(), left.end(), right.begin(), right.end());
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const SmallVector &vect)
+    {
+        os << "[ ";
+        for (const T &v : vect)
+        {
+            __strlib_utils::write_value(os, v);
+            os << " ";
+        }
+        os << "]";
+        return os;
+    }
+
+private:
+    alignas(T) std::byte storage[N * sizeof(T)];
+    [[no_unique_address]] Allocator allocator;
+    T *heap; // nullptr while the items fit in storage
+    size_t length;
+    size_t allocated;
+
+    // move the items into new_items (with space for capacity items) and free the old heap allocation
+    void move_to(T *new_items, const size_t capacity)
+    {
+        for (size_t i = 0; i < length; ++i)
+        {
+            AllocatorTraits::construct(allocator, new_items + i, std::move(data()[i]));
+            AllocatorTraits::destroy(allocator, data() + i);
+        }
+        free_heap();
+        heap = new_items;
+        allocated = capacity;
+    }
+
+    void free_heap()
+    {
+        if (heap)
+            AllocatorTraits::deallocate(allocator, heap, allocated);
+        heap = nullptr;
+        allocated = N;
+    }
+
+    // take other's items, leaving it empty. This must be empty and inline
+    void take(SmallVector &other)
+    {
+        if (other.heap)
+        {
+            heap = std::exchange(other.heap, nullptr);
+            allocated = std::exchange(other.allocated, N);
+            length = std::exchange(other.length, 0);
+            return;
+        }
+        copy_moved(other);
+        other.clear();
+    }
+
+    // copy other's items onto the end of this
+    void copy(const SmallVector &other)
+    {
+        reserve(length + other.length);
+        for (const T &item : other)
+            emplace_back(item);
+    }
+
+    // move other's items onto the end of this, leaving them moved from in other
+    void copy_moved(SmallVector &other)
+    {
+        reserve(length + other.length);
+        for (T &item : other)
+            emplace_back(std::move(item));
+    }
+};
+
+#endif
@@ -1,18 +1,35 @@
 #include <assert.h>
 #include <iostream>
 #include <vector>
+#include <string>
 #include <exception>
 #include <functional>
+#include <memory_resource>
 #include "itertools.h"
+#include "small_vector.h"
+#include "arena.h"
 #include "ctest.h"
 
+namespace stack
+{
+    // items a stack holds before allocating, so short lived stacks never allocate
+    constexpr size_t INLINE_SIZE{8};
+}
+
 template <typename T>
 class Stack
 {
 public:
-    Stack<T>() : values{} {};
-    Stack<T>(std::vector<T> init_values) : values{init_values} {};
-    Stack<T>(std::initializer_list<T> init_values) : values{init_values} {};
+    Stack() : values{} {};
+    // once the stack outgrows its inline items they are allocated from resource, which must outlive the stack
+    explicit Stack(std::pmr::memory_resource *resource) : values(std::pmr::polymorphic_allocator<T>(resource)) {};
+    Stack(const std::vector<T> &init_values) : values{}
+    {
+        values.reserve(init_values.size());
+        for (const T &value : init_values)
+            values.push_back(value);
+    };
+    Stack(std::initializer_list<T> init_values) : values{init_values} {};
 
     // add a copy of the item to the stack
     void add(const T item) { values.push_back(item); }
@@ -41,7 +58,7 @@ public:
     operator bool() const { return !values.empty(); }
 
 private:
-    std::vector<T> values;
+    SmallVector<T, stack::INLINE_SIZE, std::pmr::polymorphic_allocator<T>> values;
 };
 
 void test_stack()
@@ -67,15 +84,48 @@ void test_stack_ostream()
     ctest::assert_outstream(stack, "[ 1 2 3 4 5 ]");
 }
 
+void test_stack_large()
+{
+    // more items than fit inline
+    Stack<int> stack{std::vector<int>{1, 2, 3}};
+    for (int i = 4; i <= 100; ++i)
+        stack.add(i);
+    for (int i = 100; i >= 1; --i)
+        ctest::assert_equal(stack.pop(), i);
+    assert(stack.empty());
+
+    Stack<std::string> strings{};
+    for (int i = 0; i < 20; ++i)
+        strings.add(std::string(i, 'a'));
+    Stack<std::string> copy{strings};
+    strings.clear();
+    ctest::assert_equal(copy.pop(), std::string(19, 'a'));
+}
+
 void test_stack_bool()
 {
     assert(!Stack<int>{});
     assert(Stack<int>{1});
 }
 
+void test_stack_memory_resource()
+{
+    arena::MonotonicArena arena{};
+    {
+        const ctest::ScopedDefaultResource no_default_allocations{std::pmr::null_memory_resource()};
+        Stack<int> stack{&arena};
+        for (int i = 0; i < 100; ++i)
+            stack.add(i);
+        ctest::assert_equal(stack.pop(), 99);
+    }
+    assert(arena.allocated_bytes() > 0);
+}
+
 int main()
 {
     test_stack();
     test_stack_ostream();
+    test_stack_large();
     test_stack_bool();
+    test_stack_memory_resource();
 }
\ No newline at end of file
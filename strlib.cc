@@ -1,6 +1,14 @@
 #include <assert.h>
 #include <string>
+#include <string_view>
+#include <array>
+#include <iterator>
+#include <cstdint>
+#include <limits>
+#include <random>
 #include "strlib.h"
+#include "itertools.h"
+#include "functools.h"
 #include "ctest.h"
 
 struct test_struct
@@ -8,6 +16,17 @@ struct test_struct
     int a;
 };
 
+struct printable_struct
+{
+    int a;
+
+    friend std::ostream &operator<<(std::ostream &os, const printable_struct &value)
+    {
+        os << "printable_struct(" << value.a << ")";
+        return os;
+    }
+};
+
 void test_printable()
 {
     static_assert(strlib::Printable<std::string>);
@@ -46,6 +65,46 @@ void test_format()
     ctest::assert_equal(result5, "int: 1 bool: 1 string: yes");
 
     std::cout << strlib::format("int: {} bool: {} string: {}", 1, true, "yes") << std::endl;
+
+    ctest::assert_equal(strlib::format("{}{}", 'a', std::string{"b"}), "ab");
+    ctest::assert_equal(strlib::format("{} {} {}", -42, 2.5, 1e20), "-42 2.5 1e+20");
+    ctest::assert_equal(strlib::format("{} and {}", 18446744073709551615ul, -0.125f), "18446744073709551615 and -0.125");
+    ctest::assert_equal(strlib::format("{{}}", 1), "{1}");
+    ctest::assert_equal(strlib::format("no placeholders", 1), "no placeholders");
+    ctest::assert_equal(strlib::format("nothing to fill"), "nothing to fill");
+    ctest::assert_equal(strlib::format("{}", printable_struct{5}), "printable_struct(5)");
+
+    // null pointers are printed rather than read
+    const char *const null_str{nullptr};
+    ctest::assert_equal(strlib::format("p={}", nullptr), "p=nullptr");
+    ctest::assert_equal(strlib::format("s={}", null_str), "s=nullptr");
+    ctest::assert_equal(strlib::formatted_size("s={}", null_str), 9);
+}
+
+void test_format_string()
+{
+    // literal format strings are parsed at compile time
+    constexpr strlib::format_string<int, int> two_args{"a {} b {} c {}"};
+    static_assert(two_args.num_placeholders() == 2);
+    static_assert(two_args.placeholder(0) == 2);
+    static_assert(two_args.placeholder(1) == 7);
+    static_assert(strlib::format_string<int>{"{"}.num_placeholders() == 0);
+    static_assert(strlib::format_string<int>{"}{"}.num_placeholders() == 0);
+
+    // while runtime strings are parsed when constructed
+    std::string runtime_str{"{}{}"};
+    strlib::format_string<int, int, int> runtime_fmt{runtime_str};
+    ctest::assert_equal(runtime_fmt.num_placeholders(), 2);
+    ctest::assert_equal(runtime_fmt.placeholder(1), 2);
+
+    // as are char pointers and string_views
+    const char *const pointer_fmt{"a{}b{}"};
+    const std::string_view view_fmt{"{}{}"};
+    ctest::assert_equal(strlib::format(pointer_fmt, 1, 2), "a1b2");
+    ctest::assert_equal(strlib::format(view_fmt.substr(2), 3), "3");
+    ctest::assert_equal(strlib::format(std::string_view{}), "");
+    ctest::raises<std::invalid_argument>([]()
+                                         { strlib::format(static_cast<const char *>(nullptr), 1); });
 }
 
 void test_split()
@@ -55,6 +114,302 @@ void test_split()
     ctest::assert_equal(strlib::split(input), expected);
 
     ctest::assert_equal(strlib::split("Hello"), std::vector<std::string>{"Hello"});
+
+    // surrounding and repeated whitespace doesn't produce extra words
+    ctest::assert_equal(strlib::split("  Hello\t there \n"), std::vector<std::string>{"Hello", "there"});
+    ctest::assert_equal(strlib::split(""), std::vector<std::string>{});
+    ctest::assert_equal(strlib::split("   "), std::vector<std::string>{});
+}
+
+// collect the tokens into a vector, so they can be compared
+template <typename Tokenizer>
+std::vector<std::string_view> collect_tokens(const Tokenizer &tokenizer)
+{
+    return std::vector<std::string_view>(tokenizer.begin(), tokenizer.end());
+}
+
+void test_tokenize()
+{
+    std::string line{"a,bb,,ccc,"};
+    ctest::assert_equal(collect_tokens(strlib::tokenize(line, ',')), std::vector<std::string_view>{"a", "bb", "", "ccc", ""});
+    ctest::assert_equal(collect_tokens(strlib::tokenize("abc", ',')), std::vector<std::string_view>{"abc"});
+    ctest::assert_equal(collect_tokens(strlib::tokenize("", ',')), std::vector<std::string_view>{""});
+    ctest::assert_equal(collect_tokens(strlib::tokenize(std::string_view{}, ',')), std::vector<std::string_view>{""});
+
+    // tokens point into the original string
+    ctest::assert_equal((*strlib::tokenize(line, ',').begin()).data(), line.data());
+    static_assert(std::ranges::forward_range<strlib::Tokenizer<__strlib_utils::CharDelimiter>>);
+
+    // multi character delimiters
+    ctest::assert_equal(collect_tokens(strlib::tokenize("a::b:c::::d", "::")), std::vector<std::string_view>{"a", "b:c", "", "d"});
+    ctest::assert_equal(collect_tokens(strlib::tokenize("a:", "::")), std::vector<std::string_view>{"a:"});
+    ctest::assert_equal(collect_tokens(strlib::tokenize("ab", "abc")), std::vector<std::string_view>{"ab"});
+    ctest::raises<std::invalid_argument>([]()
+                                         { strlib::tokenize("abc", ""); });
+
+    // the delimiter is copied, so a temporary one lives as long as the tokenizer
+    std::vector<std::string_view> fields{};
+    for (const std::string_view field : strlib::tokenize(line, std::string(",,")))
+        fields.push_back(field);
+    ctest::assert_equal(fields, std::vector<std::string_view>{"a,bb", "ccc,"});
+
+    // iterators don't refer back to the tokenizer, so they outlive a temporary one
+    auto iter{strlib::tokenize(line, std::string(",")).begin()};
+    ++iter;
+    ctest::assert_equal(*iter, "bb");
+    const auto end{strlib::tokenize(line, std::string(",")).end()};
+    std::vector<std::string_view> rest{};
+    for (++iter; iter != end; ++iter)
+        rest.push_back(*iter);
+    ctest::assert_equal(rest, std::vector<std::string_view>{"", "ccc", ""});
+    static_assert(std::ranges::forward_range<strlib::Tokenizer<__strlib_utils::StringDelimiter>>);
+
+    // predicate delimiters
+    auto is_digit{[](const char c)
+                  { return c >= '0' && c <= '9'; }};
+    ctest::assert_equal(collect_tokens(strlib::tokenize("ab1cd23e", is_digit)), std::vector<std::string_view>{"ab", "cd", "", "e"});
+
+    // whitespace
+    ctest::assert_equal(collect_tokens(strlib::tokenize(" one  two\tthree\n")), std::vector<std::string_view>{"one", "two", "three"});
+    ctest::assert_equal(collect_tokens(strlib::tokenize(" \n ")), std::vector<std::string_view>{});
+}
+
+void test_format_to()
+{
+    // into a stack buffer
+    std::array<char, 32> buffer{};
+    char *end{strlib::format_to(buffer.data(), "{} + {} = {}", 1, 2, 3)};
+    ctest::assert_equal(std::string_view(buffer.data(), end), "1 + 2 = 3");
+
+    // appending to a reused string
+    std::string reused{"log: "};
+    strlib::format_to(std::back_inserter(reused), "{} {}", "event", 7);
+    ctest::assert_equal(reused, "log: event 7");
+    reused.clear();
+    strlib::format_to(std::back_inserter(reused), "{}", 2.5);
+    ctest::assert_equal(reused, "2.5");
+
+    // straight into a stream buffer
+    std::ostringstream stream{};
+    strlib::format_to(std::ostreambuf_iterator<char>(stream), "[{}]", true);
+    ctest::assert_equal(stream.str(), "[1]");
+}
+
+void test_format_to_n()
+{
+    std::array<char, 8> buffer{};
+    strlib::format_to_n_result<char *> result{strlib::format_to_n(buffer.data(), 5, "{} and {}", 12345, "more")};
+    ctest::assert_equal(result.size, 14);
+    ctest::assert_equal(std::string_view(buffer.data(), result.out), "12345");
+
+    std::array<char, 32> large_buffer{};
+    result = strlib::format_to_n(large_buffer.data(), large_buffer.size(), "{} and {}", 12345, "more");
+    ctest::assert_equal(result.size, 14);
+    ctest::assert_equal(std::string_view(large_buffer.data(), result.out), "12345 and more");
+
+    result = strlib::format_to_n(buffer.data(), 0, "{}", 1);
+    ctest::assert_equal(result.out, buffer.data());
+}
+
+void test_formatted_size()
+{
+    ctest::assert_equal(strlib::formatted_size("{} and {}", 12345, "more"), 14);
+    ctest::assert_equal(strlib::formatted_size("{}{}", -1, 'c'), 3);
+    ctest::assert_equal(strlib::formatted_size("plain"), 5);
+    ctest::assert_equal(strlib::formatted_size("{}", printable_struct{10}), strlib::format("{}", printable_struct{10}).length());
+}
+
+void test_find()
+{
+    const std::string text{"the quick brown fox jumps over the lazy dog, the end"};
+    ctest::assert_equal(strlib::find(text, "the"), 0);
+    ctest::assert_equal(strlib::find(text, "the", 1), 31);
+    ctest::assert_equal(strlib::find(text, "dog"), 40);
+    ctest::assert_equal(strlib::find(text, "end"), 49);
+    ctest::assert_equal(strlib::find(text, "q"), 4);
+    ctest::assert_equal(strlib::find(text, ""), 0);
+    ctest::assert_equal(strlib::find(text, "cat"), std::string_view::npos);
+    ctest::assert_equal(strlib::find(text, "the", 1000), std::string_view::npos);
+    ctest::assert_equal(strlib::find("ab", "abc"), std::string_view::npos);
+
+    // agrees with std::string_view::find for every needle and offset, crossing the vector block boundaries
+    std::string long_text{};
+    for (const int i : itertools::range(0, 200))
+        long_text += static_cast<char>('a' + (i * 7) % 5);
+    for (const int start : itertools::range(0, 100, 3))
+        for (const int length : itertools::range(1, 6))
+        {
+            const std::string_view needle{std::string_view(long_text).substr(start, length)};
+            for (const int from : itertools::range(0, 200, 13))
+                ctest::assert_equal(strlib::find(long_text, needle, from), std::string_view(long_text).find(needle, from));
+        }
+    ctest::assert_equal(strlib::find(long_text, "zz"), std::string_view::npos);
+}
+
+void test_search_helpers()
+{
+    assert(strlib::contains("hello there", "lo th"));
+    assert(!strlib::contains("hello there", "general"));
+    ctest::assert_equal(strlib::count("abababa", "aba"), 2);
+    ctest::assert_equal(strlib::count("aaaa", "a"), 4);
+    ctest::assert_equal(strlib::count("aaaa", "b"), 0);
+    ctest::raises<std::invalid_argument>([]()
+                                         { strlib::count("abc", ""); });
+
+    assert(strlib::starts_with("hello there", "hello"));
+    assert(strlib::starts_with("hello there", ""));
+    assert(!strlib::starts_with("hello", "hello there"));
+    assert(strlib::ends_with("hello there", "there"));
+    assert(!strlib::ends_with("hello there", "hello"));
+    // default constructed views have null data pointers
+    assert(strlib::starts_with(std::string_view{}, std::string_view{}));
+    assert(strlib::ends_with(std::string_view{}, std::string_view{}));
+    assert(strlib::ends_with("hello", std::string_view{}));
+    assert(!strlib::starts_with(std::string_view{}, "h"));
+
+    typedef std::optional<std::tuple<size_t, size_t>> AnyMatch;
+    ctest::assert_equal(strlib::find_any("ERROR: disk full", {"WARN", "ERROR", "disk"}), AnyMatch{{0, 1}});
+    ctest::assert_equal(strlib::find_any("ok: disk full", {"WARN", "ERROR", "disk"}), AnyMatch{{4, 2}});
+    ctest::assert_equal(strlib::find_any("abc", {"bc", "b"}), AnyMatch{{1, 0}});
+    ctest::assert_equal(strlib::find_any("all good", {"WARN", "ERROR"}), AnyMatch{});
+    ctest::assert_equal(strlib::find_any("single", {"gl"}), AnyMatch{{3, 0}});
+}
+
+void test_search_filter()
+{
+    std::vector<std::string> lines{"INFO started", "ERROR disk full", "INFO running", "ERROR out of memory"};
+    auto is_error{[](const std::string &line)
+                  { return strlib::starts_with(line, "ERROR"); }};
+    ctest::assert_equal(functools::filter(is_error, lines), std::vector<std::string>{"ERROR disk full", "ERROR out of memory"});
+
+    auto mentions_disk{[](const std::string &line)
+                       { return strlib::contains(line, "disk"); }};
+    ctest::assert_equal(functools::count(mentions_disk, lines), 1);
+}
+
+void test_to_chars()
+{
+    ctest::assert_equal(strlib::to_str(0), "0");
+    ctest::assert_equal(strlib::to_str(7), "7");
+    ctest::assert_equal(strlib::to_str(-10), "-10");
+    ctest::assert_equal(strlib::to_str(1234567), "1234567");
+    ctest::assert_equal(strlib::to_str(std::numeric_limits<int64_t>::min()), "-9223372036854775808");
+    ctest::assert_equal(strlib::to_str(std::numeric_limits<uint64_t>::max()), "18446744073709551615");
+    ctest::assert_equal(strlib::to_str(std::numeric_limits<int16_t>::min()), "-32768");
+    ctest::assert_equal(strlib::to_str(true), "true");
+
+    // floats are printed in the shortest form that parses back to the same value
+    ctest::assert_equal(strlib::to_str(0.1), "0.1");
+    ctest::assert_equal(strlib::to_str(1.0 / 3), "0.3333333333333333");
+    ctest::assert_equal(strlib::to_str(-2.5f), "-2.5");
+    ctest::assert_equal(strlib::to_str(1e100), "1e+100");
+
+    std::array<char, 4> buffer{};
+    const std::to_chars_result fits{strlib::to_chars(buffer.data(), buffer.data() + buffer.size(), -123)};
+    ctest::assert_equal(std::string_view(buffer.data(), fits.ptr), "-123");
+    const std::to_chars_result too_long{strlib::to_chars(buffer.data(), buffer.data() + buffer.size(), 12345)};
+    assert(too_long.ec == std::errc::value_too_large);
+    assert(too_long.ptr == buffer.data() + buffer.size());
+
+    // containers print their numbers the same way
+    ctest::assert_outstream(std::vector<double>{0.1, 1e20}, "[ 0.1 1e+20 ]");
+    ctest::assert_outstream(std::make_tuple(1.5, -3), "(1.5, -3)");
+    ctest::assert_outstream(std::optional<long>{-9}, "-9");
+    ctest::assert_outstream(0.2, "0.2");
+}
+
+void test_parse()
+{
+    ctest::assert_equal(strlib::parse<int>("0"), 0);
+    ctest::assert_equal(strlib::parse<int>("42"), 42);
+    ctest::assert_equal(strlib::parse<int>("-42"), -42);
+    ctest::assert_equal(strlib::parse<int>("12345678"), 12345678);
+    ctest::assert_equal(strlib::parse<int>("-2147483648"), std::numeric_limits<int>::min());
+    ctest::assert_equal(strlib::parse<int>("2147483647"), std::numeric_limits<int>::max());
+    ctest::assert_equal(strlib::parse<int64_t>("-9223372036854775808"), std::numeric_limits<int64_t>::min());
+    ctest::assert_equal(strlib::parse<uint64_t>("18446744073709551615"), std::numeric_limits<uint64_t>::max());
+    ctest::assert_equal(strlib::parse<uint16_t>("65535"), uint16_t{65535});
+    // long strings are still parsed correctly
+    ctest::assert_equal(strlib::parse<int>("000000000000000000000000012"), 12);
+
+    // out of range
+    assert(!strlib::parse<int>("2147483648"));
+    assert(!strlib::parse<int>("-2147483649"));
+    assert(!strlib::parse<uint16_t>("65536"));
+    assert(!strlib::parse<uint64_t>("18446744073709551616"));
+    assert(!strlib::parse<unsigned>("-1"));
+
+    // not numbers, including a bad character in the 8 digit block or after it
+    assert(!strlib::parse<int>(""));
+    assert(!strlib::parse<int>("-"));
+    assert(!strlib::parse<int>("+1"));
+    assert(!strlib::parse<int>(" 1"));
+    assert(!strlib::parse<int>("1 "));
+    assert(!strlib::parse<int>("1234x678"));
+    assert(!strlib::parse<int>("12345678x"));
+    assert(!strlib::parse<int>("1234:678"));
+    assert(!strlib::parse<int>("1234/678"));
+    assert(!strlib::parse<int>("1.5"));
+
+    ctest::assert_equal(strlib::parse<double>("0.1"), 0.1);
+    ctest::assert_equal(strlib::parse<double>("-1e+20"), -1e20);
+    ctest::assert_equal(strlib::parse<float>("2.5"), 2.5f);
+    assert(!strlib::parse<double>("abc"));
+    assert(!strlib::parse<double>("1.5x"));
+    assert(!strlib::parse<double>("1e999"));
+}
+
+void test_parse_round_trip()
+{
+    std::mt19937_64 generator{42};
+    for (int i = 0; i < 100000; ++i)
+    {
+        const uint64_t bits{generator()};
+        // vary the number of digits rather than having almost every number be 19 or 20 digits long
+        const int64_t integer{static_cast<int64_t>(bits) >> (bits % 64)};
+        ctest::assert_equal(strlib::parse<int64_t>(strlib::to_str(integer)), integer);
+        const uint32_t unsigned_integer(bits >> (bits % 64));
+        ctest::assert_equal(strlib::parse<uint32_t>(strlib::to_str(unsigned_integer)), unsigned_integer);
+        const double floating{std::bit_cast<double>(bits & 0xBFFFFFFFFFFFFFFF)}; // clear an exponent bit so it's finite
+        ctest::assert_equal(strlib::parse<double>(strlib::to_str(floating)), floating);
+    }
+}
+
+void benchmark_numbers()
+{
+    std::vector<int64_t> numbers(1000000);
+    std::mt19937_64 generator{42};
+    for (int64_t &number : numbers)
+        number = static_cast<int64_t>(generator() >> (generator() % 64));
+
+    std::vector<std::string> printed(numbers.size());
+    const double print_seconds{ctest::time_it([&]()
+                                              { for (size_t i = 0; i < numbers.size(); ++i) printed[i] = strlib::to_str(numbers[i]); })};
+    const double stream_print_seconds{ctest::time_it([&]()
+                                                     { for (size_t i = 0; i < numbers.size(); ++i)
+                                                       {
+                                                           std::ostringstream stream{};
+                                                           stream << numbers[i];
+                                                           printed[i] = stream.str();
+                                                       } })};
+
+    uint64_t total{0}; // unsigned so the sum can wrap around
+    const double parse_seconds{ctest::time_it([&]()
+                                              { for (const std::string &str : printed) total += strlib::parse<int64_t>(str).value(); })};
+    uint64_t stream_total{0};
+    const double stream_parse_seconds{ctest::time_it([&]()
+                                                     { for (const std::string &str : printed)
+                                                       {
+                                                           std::istringstream stream{str};
+                                                           int64_t value;
+                                                           stream >> value;
+                                                           stream_total += value;
+                                                       } })};
+    ctest::assert_equal(total, stream_total);
+
+    const double count(numbers.size());
+    std::cout << "ns per int64: print " << print_seconds * 1e9 / count << " (stream " << stream_print_seconds * 1e9 / count
+              << "), parse " << parse_seconds * 1e9 / count << " (stream " << stream_parse_seconds * 1e9 / count << ")" << std::endl;
 }
 
 int main()
@@ -62,5 +417,17 @@ int main()
     test_printable();
     test_outstream();
     test_format();
+    test_format_string();
+    test_format_to();
+    test_format_to_n();
+    test_formatted_size();
     test_split();
+    test_tokenize();
+    test_find();
+    test_search_helpers();
+    test_search_filter();
+    test_to_chars();
+    test_parse();
+    test_parse_round_trip();
+    benchmark_numbers();
 }
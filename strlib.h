@@ -2,11 +2,26 @@
 #define STRLIB
 
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <vector>
+#include <optional>
+#include <array>
+#include <algorithm>
+#include <iterator>
+#include <charconv>
+#include <bit>
+#include <tuple>
+#include <cstring>
+#include <stdexcept>
 #include <concepts>
+#include <type_traits>
+#include <limits>
+#include <cstdint>
 #include <iostream>
-#include "slice.h"
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 namespace strlib
 {
@@ -22,44 +37,761 @@ namespace strlib
         } -> std::same_as<std::ostream &>;
     };
 
-    // split string by spaces
-    std::vector<std::string> split(const std::string &str)
+}
+
+namespace __strlib_utils
+{
+    // Substring search for needles of at least 2 characters, returning npos if needle isn't found at or after from
+    // A position is only a candidate if both the first and last characters of the needle match there,
+    // the vector kernels test this for a whole block of positions at once, then confirm candidates with memcmp
+
+    inline size_t find_scalar(const std::string_view haystack, const std::string_view needle, size_t from)
     {
-        std::istringstream stream{str};
-        std::vector<std::string> result{};
-        std::string curr_word{};
-        while (!stream.eof())
+        const size_t last_start{haystack.length() - needle.length()};
+        while (from <= last_start)
         {
-            stream >> curr_word;
-            result.push_back(curr_word);
+            const void *found{std::memchr(haystack.data() + from, needle.front(), last_start + 1 - from)};
+            if (!found)
+                break;
+            const size_t position(static_cast<const char *>(found) - haystack.data());
+            if (haystack[position + needle.length() - 1] == needle.back() &&
+                std::memcmp(haystack.data() + position + 1, needle.data() + 1, needle.length() - 2) == 0)
+                return position;
+            from = position + 1;
         }
-        return result;
+        return std::string_view::npos;
     }
 
-    template <Printable Item, Printable... Items>
-    std::string format(const std::string &str, const Item &arg, const Items... args)
+#if defined(__SSE2__)
+    inline size_t find_sse2(const std::string_view haystack, const std::string_view needle, size_t from)
     {
-        // gradually extract from str, when finding two brackets then insert the arg instead
-        const long length{static_cast<long>(str.length())};
-        std::ostringstream result{};
-        for (int i = 0; i < length; ++i)
+        const __m128i first{_mm_set1_epi8(needle.front())};
+        const __m128i last{_mm_set1_epi8(needle.back())};
+        const size_t last_offset{needle.length() - 1};
+        for (; from + last_offset + 16 <= haystack.length(); from += 16)
         {
-            if (str[i] == '{' && i + 1 < length && str[i + 1] == '}')
+            const __m128i block_first{_mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack.data() + from))};
+            const __m128i block_last{_mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack.data() + from + last_offset))};
+            unsigned mask(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last))));
+            while (mask != 0)
             {
-                result << arg;
-                // add remaining args, skipping over closing bracket
-                auto sliced{itertools::slice(str, i + 2, length)};
-                std::string remaining(sliced.begin(), sliced.end());
-                if constexpr (sizeof...(args) > 0)
-                    result << strlib::format(remaining, args...);
-                else
-                    result << remaining;
-                break;
+                const size_t position{from + std::countr_zero(mask)};
+                if (std::memcmp(haystack.data() + position + 1, needle.data() + 1, needle.length() - 2) == 0)
+                    return position;
+                mask &= mask - 1;
+            }
+        }
+        return find_scalar(haystack, needle, from);
+    }
+#endif
+
+#if defined(__AVX2__)
+    inline size_t find_avx2(const std::string_view haystack, const std::string_view needle, size_t from)
+    {
+        const __m256i first{_mm256_set1_epi8(needle.front())};
+        const __m256i last{_mm256_set1_epi8(needle.back())};
+        const size_t last_offset{needle.length() - 1};
+        for (; from + last_offset + 32 <= haystack.length(); from += 32)
+        {
+            const __m256i block_first{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(haystack.data() + from))};
+            const __m256i block_last{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(haystack.data() + from + last_offset))};
+            unsigned mask(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last))));
+            while (mask != 0)
+            {
+                const size_t position{from + std::countr_zero(mask)};
+                if (std::memcmp(haystack.data() + position + 1, needle.data() + 1, needle.length() - 2) == 0)
+                    return position;
+                mask &= mask - 1;
             }
-            else
-                result << str[i];
         }
-        return result.str();
+        return find_scalar(haystack, needle, from);
+    }
+#endif
+
+    // use the widest kernel the target was compiled for
+    inline size_t find_substring(const std::string_view haystack, const std::string_view needle, const size_t from)
+    {
+#if defined(__AVX2__)
+        return find_avx2(haystack, needle, from);
+#elif defined(__SSE2__)
+        return find_sse2(haystack, needle, from);
+#else
+        return find_scalar(haystack, needle, from);
+#endif
+    }
+}
+
+namespace strlib
+{
+    // Offset of the first occurrence of needle in haystack at or after from, or npos if there isn't one
+    inline size_t find(const std::string_view haystack, const std::string_view needle, const size_t from = 0)
+    {
+        if (from > haystack.length() || needle.length() > haystack.length() - from)
+            return std::string_view::npos;
+        if (needle.empty())
+            return from;
+        if (needle.length() == 1)
+        {
+            // memchr is already vectorised by the C library
+            const void *found{std::memchr(haystack.data() + from, needle.front(), haystack.length() - from)};
+            return (found) ? static_cast<const char *>(found) - haystack.data() : std::string_view::npos;
+        }
+        return __strlib_utils::find_substring(haystack, needle, from);
+    }
+
+    inline bool contains(const std::string_view haystack, const std::string_view needle)
+    {
+        return find(haystack, needle) != std::string_view::npos;
+    }
+
+    // number of non-overlapping occurrences of needle in haystack
+    inline size_t count(const std::string_view haystack, const std::string_view needle)
+    {
+        if (needle.empty())
+            throw std::invalid_argument("needle cannot be empty");
+        size_t occurrences{0};
+        for (size_t position{find(haystack, needle)}; position != std::string_view::npos; position = find(haystack, needle, position + needle.length()))
+            ++occurrences;
+        return occurrences;
+    }
+
+    // empty views can have null data pointers, which memcmp mustn't be given even to compare nothing
+    inline bool starts_with(const std::string_view str, const std::string_view prefix)
+    {
+        return prefix.empty() || (prefix.length() <= str.length() && std::memcmp(str.data(), prefix.data(), prefix.length()) == 0);
+    }
+
+    inline bool ends_with(const std::string_view str, const std::string_view suffix)
+    {
+        return suffix.empty() ||
+               (suffix.length() <= str.length() && std::memcmp(str.data() + str.length() - suffix.length(), suffix.data(), suffix.length()) == 0);
+    }
+
+    // Find the earliest occurrence of any of the needles, returning (offset, index of the needle that matched)
+    // If several needles match at the same offset, the first of them in needles is returned
+    inline std::optional<std::tuple<size_t, size_t>> find_any(const std::string_view haystack, const std::vector<std::string_view> &needles)
+    {
+        if (std::ranges::any_of(needles, [](const std::string_view needle)
+                                { return needle.empty(); }))
+            throw std::invalid_argument("needles cannot be empty");
+        if (needles.size() == 1)
+        {
+            const size_t position{find(haystack, needles.front())};
+            return (position == std::string_view::npos) ? std::nullopt : std::make_optional(std::make_tuple(position, size_t{0}));
+        }
+
+        // only check the needles at offsets holding the first character of one of them
+        std::array<bool, 256> first_chars{};
+        for (const std::string_view needle : needles)
+            first_chars[static_cast<unsigned char>(needle.front())] = true;
+        for (size_t position = 0; position < haystack.length(); ++position)
+        {
+            if (!first_chars[static_cast<unsigned char>(haystack[position])])
+                continue;
+            for (size_t needle_idx = 0; needle_idx < needles.size(); ++needle_idx)
+                if (starts_with(haystack.substr(position), needles[needle_idx]))
+                    return std::make_tuple(position, needle_idx);
+        }
+        return std::nullopt;
+    }
+
+    // A format string whose "{}" placeholders are found when it is constructed
+    // String literals are parsed at compile time, other strings are parsed at runtime
+    // Only the first NumArgs placeholders are recorded, any after that are left as they are
+    template <size_t NumArgs>
+    class FormatString
+    {
+    public:
+        template <size_t N>
+        consteval FormatString(const char (&str)[N]) : str{str}, positions{}, count{0} { find_placeholders(); }
+
+        FormatString(const std::string &str) : str{str}, positions{}, count{0} { find_placeholders(); }
+
+        FormatString(const std::string_view str) : str{str}, positions{}, count{0} { find_placeholders(); }
+
+        // a char pointer would otherwise need two conversions, through string_view
+        template <typename Str>
+            requires std::same_as<Str, const char *> || std::same_as<Str, char *>
+        FormatString(const Str str) : FormatString(checked_view(str)) {}
+
+        constexpr std::string_view view() const { return str; }
+
+        constexpr size_t num_placeholders() const { return count; }
+
+        // the offset of the idx'th placeholder in the string
+        constexpr size_t placeholder(const size_t idx) const { return positions[idx]; }
+
+    private:
+        std::string_view str;
+        std::array<size_t, NumArgs> positions;
+        size_t count;
+
+        static std::string_view checked_view(const char *str)
+        {
+            if (!str)
+                throw std::invalid_argument("format string cannot be null");
+            return str;
+        }
+
+        constexpr void find_placeholders()
+        {
+            if (std::is_constant_evaluated())
+            {
+                for (size_t i = 0; i + 1 < str.length() && count < NumArgs; ++i)
+                    if (str[i] == '{' && str[i + 1] == '}')
+                        positions[count++] = i++;
+                return;
+            }
+            // runtime strings can use the vectorised search
+            for (size_t i{find(str, "{}")}; i != std::string_view::npos && count < NumArgs; i = find(str, "{}", i + 2))
+                positions[count++] = i;
+        }
+    };
+
+    template <typename... Items>
+    using format_string = FormatString<sizeof...(Items)>;
+}
+
+namespace __strlib_utils
+{
+    template <typename T>
+    concept CharType = std::same_as<T, char> || std::same_as<T, signed char> || std::same_as<T, unsigned char>;
+
+    // arithmetic types that are printed and parsed as numbers, bools and chars print as themselves instead
+    template <typename T>
+    concept Number = std::is_arithmetic_v<T> && !std::same_as<T, bool> && !CharType<T>;
+
+    // "00" "01" ... "99", so integers can be printed two digits at a time
+    constexpr std::array<char, 200> DIGIT_PAIRS{[]()
+                                                {
+                                                    std::array<char, 200> pairs{};
+                                                    for (int i = 0; i < 100; ++i)
+                                                    {
+                                                        pairs[2 * i] = static_cast<char>('0' + i / 10);
+                                                        pairs[2 * i + 1] = static_cast<char>('0' + i % 10);
+                                                    }
+                                                    return pairs;
+                                                }()};
+
+    // the most digits a 64 bit integer can have
+    constexpr size_t MAX_INTEGER_DIGITS{20};
+
+    // Write the digits of value so they end just before end, returning where they start
+    inline char *write_digits_backwards(char *end, uint64_t value)
+    {
+        while (value >= 100)
+        {
+            end -= 2;
+            std::memcpy(end, DIGIT_PAIRS.data() + 2 * (value % 100), 2);
+            value /= 100;
+        }
+        if (value >= 10)
+        {
+            end -= 2;
+            std::memcpy(end, DIGIT_PAIRS.data() + 2 * value, 2);
+        }
+        else
+            *--end = static_cast<char>('0' + value);
+        return end;
+    }
+
+    // Load 8 characters into a word, the first character in the lowest byte
+    inline uint64_t load_eight_chars(const char *chars)
+    {
+        uint64_t word;
+        std::memcpy(&word, chars, sizeof(word));
+        if constexpr (std::endian::native == std::endian::big)
+            word = __builtin_bswap64(word);
+        return word;
+    }
+
+    // whether all 8 characters in the word are '0' to '9', checked for every byte at once
+    constexpr bool is_eight_digits(const uint64_t word)
+    {
+        // the high nibble of every byte must be 3, and adding 6 to the low nibble mustn't carry out of it
+        return ((word & 0xF0F0F0F0F0F0F0F0) | (((word + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333;
+    }
+
+    // Convert 8 digit characters to their value with 3 multiplies instead of 8 multiply adds
+    // adjacent digits are combined into 2 digit numbers, then 4 digit numbers, then the full 8 digit number
+    constexpr uint32_t parse_eight_digits(uint64_t word)
+    {
+        word -= 0x3030303030303030;
+        word = (word * 10) + (word >> 8);
+        word = (((word & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+                (((word >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >>
+               32;
+        return static_cast<uint32_t>(word);
+    }
+
+    // Parse a string of only digits, giving nullopt if there is any other character or it has more than 19 digits
+    // 19 digits always fit in 64 bits, so no overflow checks are needed while parsing
+    inline std::optional<uint64_t> parse_digits(const std::string_view digits)
+    {
+        if (digits.empty() || digits.length() >= MAX_INTEGER_DIGITS)
+            return std::nullopt;
+        uint64_t value{0};
+        size_t i{0};
+        for (; i + 8 <= digits.length(); i += 8)
+        {
+            const uint64_t word{load_eight_chars(digits.data() + i)};
+            if (!is_eight_digits(word))
+                return std::nullopt;
+            value = value * 100000000 + parse_eight_digits(word);
+        }
+        for (; i < digits.length(); ++i)
+        {
+            const unsigned digit(digits[i] - '0');
+            if (digit > 9)
+                return std::nullopt;
+            value = value * 10 + digit;
+        }
+        return value;
+    }
+
+    template <std::integral T>
+    std::optional<T> parse_integer(const std::string_view str)
+    {
+        const bool negative{std::is_signed_v<T> && !str.empty() && str.front() == '-'};
+        const std::string_view digits{str.substr(negative)};
+        const std::optional<uint64_t> magnitude{parse_digits(digits)};
+        if (!magnitude)
+        {
+            // long strings (e.g. with many leading zeros) go through the standard parser, which checks for overflow
+            T value;
+            const std::from_chars_result result{std::from_chars(str.data(), str.data() + str.length(), value)};
+            if (result.ec != std::errc{} || result.ptr != str.data() + str.length())
+                return std::nullopt;
+            return value;
+        }
+
+        const uint64_t max_magnitude{static_cast<uint64_t>(std::numeric_limits<T>::max()) + negative};
+        if (magnitude.value() > max_magnitude)
+            return std::nullopt;
+        // negating in unsigned arithmetic handles the most negative value, which has no positive counterpart
+        return static_cast<T>((negative) ? 0 - magnitude.value() : magnitude.value());
+    }
+}
+
+namespace strlib
+{
+    // Print a number to [first, last) without going through an ostream, like std::to_chars
+    // Integers are written two digits at a time, floats are written in the shortest form that parses back to the same value
+    // Gives errc::value_too_large and leaves the buffer unspecified if the number doesn't fit
+    template <__strlib_utils::Number T>
+    std::to_chars_result to_chars(char *first, char *last, const T value)
+    {
+        if constexpr (std::floating_point<T>)
+            return std::to_chars(first, last, value);
+        else
+        {
+            const bool negative{value < 0};
+            const uint64_t magnitude{(negative) ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value)};
+            std::array<char, __strlib_utils::MAX_INTEGER_DIGITS> buffer;
+            const char *digits{__strlib_utils::write_digits_backwards(buffer.data() + buffer.size(), magnitude)};
+            const size_t num_digits(buffer.data() + buffer.size() - digits);
+            if (static_cast<size_t>(last - first) < num_digits + negative)
+                return {last, std::errc::value_too_large};
+            if (negative)
+                *first++ = '-';
+            std::memcpy(first, digits, num_digits);
+            return {first + num_digits, std::errc{}};
+        }
+    }
+
+    template <__strlib_utils::Number T>
+    std::string to_str(const T value)
+    {
+        std::array<char, 64> buffer;
+        const std::to_chars_result result{to_chars(buffer.data(), buffer.data() + buffer.size(), value)};
+        return std::string(buffer.data(), result.ptr);
+    }
+
+    // Parse the whole string as a number, giving nullopt if it isn't one or it's out of range for T
+    // Accepts the same syntax as std::from_chars: no leading whitespace or '+', and floats can't be hex without a prefix
+    // Integers are parsed 8 digits at a time
+    template <__strlib_utils::Number T>
+    std::optional<T> parse(const std::string_view str)
+    {
+        if constexpr (std::integral<T>)
+            return __strlib_utils::parse_integer<T>(str);
+        else
+        {
+            T value;
+            const std::from_chars_result result{std::from_chars(str.data(), str.data() + str.length(), value)};
+            if (result.ec != std::errc{} || result.ptr != str.data() + str.length())
+                return std::nullopt;
+            return value;
+        }
+    }
+}
+
+namespace __strlib_utils
+{
+    // nullptr converts to string_view but isn't a string, so it is printed through the ostream instead
+    template <typename T>
+    concept StringLike = std::convertible_to<const T &, std::string_view> && !std::same_as<T, std::nullptr_t>;
+
+    // a null char pointer is printed as "nullptr", the same as nullptr, instead of being read
+    template <StringLike T>
+    constexpr std::string_view as_view(const T &value)
+    {
+        if constexpr (std::is_pointer_v<T>)
+            if (!value)
+                return "nullptr";
+        return std::string_view(value);
+    }
+
+    // rough number of characters needed to print value, used to size the output buffer up front
+    template <typename T>
+    constexpr size_t size_hint(const T &value)
+    {
+        if constexpr (StringLike<T>)
+            return as_view(value).length();
+        else if constexpr (Number<T>)
+            return 24;
+        else
+            return 16;
+    }
+
+    // Destinations for formatted output, each has append(string_view) and push_back(char)
+    // std::string can be used directly as a sink
+
+    // Writes through an output iterator
+    template <typename Out>
+    struct IteratorSink
+    {
+        Out out;
+
+        void append(const std::string_view str) { out = std::copy(str.begin(), str.end(), out); }
+        void push_back(const char c) { *out++ = c; }
+    };
+
+    // Writes at most limit characters through an output iterator, but counts every character
+    template <typename Out>
+    struct TruncatingSink
+    {
+        Out out;
+        size_t limit;
+        size_t size{0};
+
+        void append(const std::string_view str)
+        {
+            const size_t to_write{(size < limit) ? std::min(limit - size, str.length()) : 0};
+            out = std::copy(str.begin(), str.begin() + to_write, out);
+            size += str.length();
+        }
+        void push_back(const char c)
+        {
+            if (size++ < limit)
+                *out++ = c;
+        }
+    };
+
+    // Writes nothing, just counts the characters
+    struct CountingSink
+    {
+        size_t size{0};
+
+        void append(const std::string_view str) { size += str.length(); }
+        void push_back(const char) { ++size; }
+    };
+
+    // append value to the sink, numbers are written with strlib::to_chars rather than going through an ostream
+    // bools and chars print the same way an ostream would print them
+    template <typename Sink, strlib::Printable T>
+    void append_value(Sink &sink, const T &value)
+    {
+        if constexpr (std::same_as<T, bool>)
+            sink.push_back((value) ? '1' : '0');
+        else if constexpr (CharType<T>)
+            sink.push_back(static_cast<char>(value));
+        else if constexpr (Number<T>)
+        {
+            std::array<char, 64> buffer;
+            const std::to_chars_result result{strlib::to_chars(buffer.data(), buffer.data() + buffer.size(), value)};
+            sink.append(std::string_view(buffer.data(), result.ptr));
+        }
+        else if constexpr (StringLike<T>)
+            sink.append(as_view(value));
+        else
+        {
+            std::ostringstream stream{};
+            stream << value;
+            sink.append(stream.str());
+        }
+    }
+
+    // Write value to an ostream, numbers skip the ostream's locale aware formatting
+    // so floats are written in their shortest round trip form regardless of the stream's precision
+    template <strlib::Printable T>
+    void write_value(std::ostream &os, const T &value)
+    {
+        if constexpr (Number<T>)
+        {
+            std::array<char, 64> buffer;
+            const std::to_chars_result result{strlib::to_chars(buffer.data(), buffer.data() + buffer.size(), value)};
+            os.write(buffer.data(), result.ptr - buffer.data());
+        }
+        else
+            os << value;
+    }
+
+    // Replace each "{}" in the format string with the next argument, writing the result to the sink
+    template <typename Sink, strlib::Printable... Items>
+    void format_into(Sink &sink, const strlib::format_string<Items...> &str, const Items &...args)
+    {
+        const std::string_view fmt{str.view()};
+        size_t arg_idx{0};
+        size_t copied_until{0}; // everything in fmt before this offset has been written
+        auto append_arg{[&](const auto &arg)
+                        {
+                            if (arg_idx < str.num_placeholders())
+                            {
+                                const size_t position{str.placeholder(arg_idx)};
+                                sink.append(fmt.substr(copied_until, position - copied_until));
+                                append_value(sink, arg);
+                                copied_until = position + 2;
+                            }
+                            ++arg_idx;
+                        }};
+        (append_arg(args), ...);
+        sink.append(fmt.substr(copied_until));
+    }
+}
+
+namespace strlib
+{
+    // Replace each "{}" in the format string with the next argument
+    // The placeholder positions are known before formatting starts, so the output is built in one preallocated string
+    template <Printable... Items>
+    std::string format(const format_string<Items...> &str, const Items &...args)
+    {
+        std::string result{};
+        result.reserve(str.view().length() + (__strlib_utils::size_hint(args) + ... + 0));
+        __strlib_utils::format_into(result, str, args...);
+        return result;
+    }
+
+    // Format through an output iterator instead of allocating a string, returning the iterator past the last character written
+    // e.g. into a stack buffer, std::back_inserter(reused_string) or std::ostreambuf_iterator<char>(file)
+    template <std::output_iterator<const char &> Out, Printable... Items>
+    Out format_to(Out out, const format_string<Items...> &str, const Items &...args)
+    {
+        __strlib_utils::IteratorSink<Out> sink{out};
+        __strlib_utils::format_into(sink, str, args...);
+        return sink.out;
+    }
+
+    template <typename Out>
+    struct format_to_n_result
+    {
+        Out out;     // past the last character written
+        size_t size; // the untruncated length of the formatted output
+    };
+
+    // Format through an output iterator, writing at most n characters
+    template <std::output_iterator<const char &> Out, Printable... Items>
+    format_to_n_result<Out> format_to_n(Out out, const size_t n, const format_string<Items...> &str, const Items &...args)
+    {
+        __strlib_utils::TruncatingSink<Out> sink{out, n};
+        __strlib_utils::format_into(sink, str, args...);
+        return {sink.out, sink.size};
+    }
+
+    // The number of characters format would produce, without writing them anywhere
+    template <Printable... Items>
+    size_t formatted_size(const format_string<Items...> &str, const Items &...args)
+    {
+        __strlib_utils::CountingSink sink{};
+        __strlib_utils::format_into(sink, str, args...);
+        return sink.size;
+    }
+}
+
+namespace __strlib_utils
+{
+    // Delimiter policies for the tokenizer
+    // find(str, from) gives the offset and length of the first delimiter at or after from, or npos if there isn't one
+    struct DelimiterMatch
+    {
+        size_t position;
+        size_t length;
+    };
+
+    // memchr and strlib::find are vectorised, so these scan many bytes per instruction
+    struct CharDelimiter
+    {
+        char delimiter;
+
+        DelimiterMatch find(const std::string_view str, const size_t from) const
+        {
+            // an empty view can have a null data pointer, which memchr mustn't be given
+            if (from >= str.length())
+                return {std::string_view::npos, 1};
+            const void *found{std::memchr(str.data() + from, delimiter, str.length() - from)};
+            if (!found)
+                return {std::string_view::npos, 1};
+            return {static_cast<size_t>(static_cast<const char *>(found) - str.data()), 1};
+        }
+    };
+
+    // the delimiter is copied, so it can be a temporary like tokenize(line, std::string(", "))
+    struct StringDelimiter
+    {
+        std::string delimiter;
+
+        DelimiterMatch find(const std::string_view str, const size_t from) const
+        {
+            return {strlib::find(str, delimiter, from), delimiter.length()};
+        }
+    };
+
+    // every character matching the predicate is a delimiter
+    template <typename Pred>
+    struct PredicateDelimiter
+    {
+        Pred pred;
+
+        DelimiterMatch find(const std::string_view str, const size_t from) const
+        {
+            const auto found{std::find_if(str.begin() + from, str.end(), pred)};
+            if (found == str.end())
+                return {std::string_view::npos, 1};
+            return {static_cast<size_t>(found - str.begin()), 1};
+        }
+    };
+
+    // the same characters std::isspace matches in the C locale, without the locale lookup
+    constexpr bool is_space(const char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    }
+}
+
+namespace strlib
+{
+    // Lazily splits a string into tokens separated by a delimiter
+    // Tokens are string_views into the original string, so nothing is copied, and the string must outlive the tokenizer
+    // Iterators hold their own copy of the view and delimiter, so they can outlive the tokenizer they came from
+    // With skip_empty, runs of delimiters are treated as a single delimiter and empty tokens are never yielded
+    template <typename Delimiter>
+    class Tokenizer
+    {
+    public:
+        struct TokenIterator
+        {
+        public:
+            typedef std::string_view value_type;
+            typedef std::string_view reference;
+            typedef std::ptrdiff_t difference_type;
+            typedef std::forward_iterator_tag iterator_category;
+
+            TokenIterator()
+                requires std::default_initializable<Delimiter>
+                : str{}, delimiter{}, skip_empty{false}, start{std::string_view::npos}, token_end{0}, next_start{0} {}
+
+            // the iterator for the first token at or after from, from past the end of str gives an ended iterator
+            TokenIterator(const std::string_view str, const Delimiter &delimiter, const bool skip_empty, const size_t from)
+                : str{str}, delimiter{delimiter}, skip_empty{skip_empty} { find_token(from); }
+
+            reference operator*() const { return str.substr(start, token_end - start); }
+            TokenIterator &operator++()
+            {
+                find_token(next_start);
+                return *this;
+            }
+            TokenIterator operator++(int)
+            {
+                TokenIterator temp = *this;
+                ++*this;
+                return temp;
+            }
+            friend bool operator==(const TokenIterator &iter1, const TokenIterator &iter2) { return iter1.start == iter2.start; }
+            friend bool operator!=(const TokenIterator &iter1, const TokenIterator &iter2) { return !(iter1 == iter2); }
+
+        private:
+            // copied from the tokenizer, so the iterator stays valid after the tokenizer is gone
+            std::string_view str;
+            Delimiter delimiter;
+            bool skip_empty;
+            size_t start;      // start of the current token, npos at the end
+            size_t token_end;  // one past the end of the current token
+            size_t next_start; // where the following token starts, past the delimiter
+
+            void find_token(size_t from)
+            {
+                while (from <= str.length())
+                {
+                    const __strlib_utils::DelimiterMatch match{delimiter.find(str, from)};
+                    const size_t end{(match.position == std::string_view::npos) ? str.length() : match.position};
+                    if (end > from || !skip_empty)
+                    {
+                        start = from;
+                        token_end = end;
+                        next_start = (match.position == std::string_view::npos) ? str.length() + 1 : end + match.length;
+                        return;
+                    }
+                    if (match.position == std::string_view::npos)
+                        break;
+                    from = end + match.length;
+                }
+                start = std::string_view::npos;
+            }
+        };
+
+        typedef std::string_view value_type;
+        typedef TokenIterator iterator;
+        typedef TokenIterator const_iterator;
+
+        // an empty string is one empty token (like an empty field) unless empty_has_token is false, then it has none
+        Tokenizer(const std::string_view str, Delimiter delimiter, const bool skip_empty, const bool empty_has_token = true)
+            : str{str}, delimiter{std::move(delimiter)}, skip_empty{skip_empty}, empty_has_token{empty_has_token} {}
+
+        // starting past the end of the string gives an iterator that has already ended
+        iterator begin() const { return TokenIterator(str, delimiter, skip_empty, (str.empty() && !empty_has_token) ? 1 : 0); }
+        iterator end() const { return TokenIterator(str, delimiter, skip_empty, str.length() + 1); }
+
+    private:
+        std::string_view str;
+        Delimiter delimiter;
+        bool skip_empty;
+        bool empty_has_token;
+    };
+
+    // Split on runs of whitespace, ignoring leading and trailing whitespace
+    inline Tokenizer<__strlib_utils::PredicateDelimiter<bool (*)(char)>> tokenize(const std::string_view str)
+    {
+        return Tokenizer<__strlib_utils::PredicateDelimiter<bool (*)(char)>>(str, {&__strlib_utils::is_space}, true);
+    }
+
+    // Split on every occurrence of the delimiter, so consecutive delimiters give empty tokens e.g. for delimited fields
+    inline Tokenizer<__strlib_utils::CharDelimiter> tokenize(const std::string_view str, const char delimiter)
+    {
+        return Tokenizer<__strlib_utils::CharDelimiter>(str, {delimiter}, false);
+    }
+
+    inline Tokenizer<__strlib_utils::StringDelimiter> tokenize(const std::string_view str, const std::string_view delimiter)
+    {
+        if (delimiter.empty())
+            throw std::invalid_argument("delimiter cannot be empty");
+        return Tokenizer<__strlib_utils::StringDelimiter>(str, {std::string(delimiter)}, false);
+    }
+
+    // Split on every character matching the predicate
+    template <std::predicate<char> Pred>
+    Tokenizer<__strlib_utils::PredicateDelimiter<Pred>> tokenize(const std::string_view str, const Pred &pred)
+    {
+        return Tokenizer<__strlib_utils::PredicateDelimiter<Pred>>(str, {pred}, false);
+    }
+
+    // split string by whitespace, copying each word
+    std::vector<std::string> split(const std::string &str)
+    {
+        std::vector<std::string> result{};
+        for (const std::string_view token : tokenize(str))
+            result.emplace_back(token);
+        return result;
     }
 }
 
@@ -67,7 +799,11 @@ template <strlib::Printable T1, strlib::Printable T2>
 std::ostream &operator<<(std::ostream &os, const std::tuple<T1, T2> &tuple)
 {
     auto [first, second] = tuple;
-    os << "(" << first << ", " << second << ")";
+    os << "(";
+    __strlib_utils::write_value(os, first);
+    os << ", ";
+    __strlib_utils::write_value(os, second);
+    os << ")";
     return os;
 }
 
@@ -75,7 +811,7 @@ template <strlib::Printable T>
 std::ostream &operator<<(std::ostream &os, const std::optional<T> &optional)
 {
     if (optional)
-        os << optional.value();
+        __strlib_utils::write_value(os, optional.value());
     else
         os << "None";
     return os;
@@ -86,7 +822,10 @@ std::ostream &operator<<(std::ostream &os, const std::vector<T> &vect)
 {
     os << "[ ";
     for (const T v : vect)
-        os << v << " ";
+    {
+        __strlib_utils::write_value(os, v);
+        os << " ";
+    }
     os << "]";
     return os;
 }
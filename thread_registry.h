@@ -0,0 +1,92 @@
+#ifndef CPP_LEARNING_THREAD_REGISTRY
+#define CPP_LEARNING_THREAD_REGISTRY
+
+#include <atomic>
+#include <array>
+#include <vector>
+#include <mutex>
+#include <stdexcept>
+
+namespace thread_registry
+{
+    // most threads that can hold a record at once
+    constexpr int MAX_THREADS{256};
+}
+
+// Shared by the lock free reclamation schemes (hazard pointers and epochs)
+// Each thread claims a Record, which it publishes to the other threads, the first time it uses the scheme and releases it on exit
+// Retired nodes a thread couldn't free before it exited are kept as orphans, and handed to the next thread that frees nodes
+// Retired must have a pointer and a deleter(void *) to free it with
+template <typename Record, typename Retired>
+class ThreadRegistry
+{
+    // padded to a cache line, so a thread writing its record doesn't invalidate its neighbours' records
+    struct alignas(64) Slot
+    {
+        Record record{};
+        std::atomic<bool> in_use{false};
+    };
+
+public:
+    ThreadRegistry() = default;
+
+    ThreadRegistry(const ThreadRegistry &other) = delete;
+    ThreadRegistry &operator=(const ThreadRegistry &other) = delete;
+
+    // registries are static, so this runs at exit once the other threads have finished, and nothing can still be using the orphans
+    ~ThreadRegistry()
+    {
+        for (const Retired &retired : orphans)
+            retired.deleter(retired.pointer);
+    }
+
+    Record *acquire()
+    {
+        for (Slot &slot : slots)
+        {
+            bool expected{false};
+            if (!slot.in_use.load(std::memory_order_relaxed) && slot.in_use.compare_exchange_strong(expected, true))
+                return &slot.record;
+        }
+        throw std::runtime_error("too many threads are using the registry");
+    }
+
+    // the record must already be reset, so other threads ignore it until it is claimed again
+    void release(Record *record)
+    {
+        for (Slot &slot : slots)
+            if (&slot.record == record)
+                slot.in_use.store(false, std::memory_order_release);
+    }
+
+    // call function on every record currently claimed by a thread
+    template <typename Function>
+    void for_each(const Function &function) const
+    {
+        for (const Slot &slot : slots)
+            if (slot.in_use.load())
+                function(slot.record);
+    }
+
+    // keep nodes from an exiting thread
+    void orphan(const std::vector<Retired> &retired)
+    {
+        std::lock_guard<std::mutex> lock{orphans_mutex};
+        orphans.insert(orphans.end(), retired.begin(), retired.end());
+    }
+
+    // move every orphan into retired, for the calling thread to free
+    void adopt_orphans(std::vector<Retired> &retired)
+    {
+        std::lock_guard<std::mutex> lock{orphans_mutex};
+        retired.insert(retired.end(), orphans.begin(), orphans.end());
+        orphans.clear();
+    }
+
+private:
+    std::array<Slot, thread_registry::MAX_THREADS> slots;
+    std::mutex orphans_mutex;
+    std::vector<Retired> orphans;
+};
+
+#endif
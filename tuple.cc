@@ -1,4 +1,14 @@
 #include <concepts>
+#include <array>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <memory>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <iostream>
+#include <cstddef>
 #include "ctest.h"
 
 struct __end_of_args_sentinel
@@ -27,6 +37,62 @@ struct _type_at_index<0, Type, Types...>
 template <size_t Idx, typename... Types>
 using type_at_index = _type_at_index<Idx, Types...>::type;
 
+namespace __tuple_utils
+{
+    // the order the elements are stored in: largest alignment first, so no padding is needed between them
+    // elements with the same alignment keep their order
+    template <typename... Types>
+    constexpr std::array<size_t, sizeof...(Types)> storage_order()
+    {
+        constexpr std::array<size_t, sizeof...(Types)> alignments{alignof(Types)...};
+        std::array<size_t, sizeof...(Types)> order{};
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&alignments](const size_t left, const size_t right)
+                  { return alignments[left] > alignments[right] || (alignments[left] == alignments[right] && left < right); });
+        return order;
+    }
+
+    // where each element is stored, the inverse of storage_order
+    template <typename... Types>
+    constexpr std::array<size_t, sizeof...(Types)> storage_slots()
+    {
+        constexpr std::array<size_t, sizeof...(Types)> order{storage_order<Types...>()};
+        std::array<size_t, sizeof...(Types)> slots{};
+        for (size_t slot = 0; slot < order.size(); ++slot)
+            slots[order[slot]] = slot;
+        return slots;
+    }
+
+    template <typename... Types>
+    struct TypeList
+    {
+    };
+
+    // whether each of Types can be constructed from the argument at the same position, the lists must be the same length
+    template <typename Types, typename Args>
+    constexpr bool each_constructible{false};
+
+    template <typename... Types, typename... Args>
+    constexpr bool each_constructible<TypeList<Types...>, TypeList<Args...>>{(std::constructible_from<Types, Args> && ...)};
+
+    // holds the element stored in Slot, empty types take no space
+    template <size_t Slot, typename T>
+    struct Leaf
+    {
+        [[no_unique_address]] T value;
+    };
+
+    template <typename Slots, typename... Types>
+    struct Storage;
+
+    // every element is a direct base, so they are laid out one after the other instead of nested
+    template <size_t... Slots, typename... Types>
+    struct Storage<std::index_sequence<Slots...>, Types...>
+        : Leaf<Slots, type_at_index<storage_order<Types...>()[Slots], Types...>>...
+    {
+    };
+}
+
 // Can declare the class, then specify the 0 argument, and >= 1 argument cases separately
 template <typename... Types>
 class Tuple;
@@ -36,34 +102,66 @@ class Tuple<>
 {
 };
 
+// The elements are stored flat and sorted by alignment to minimise padding, get<Idx> still uses the order they were given in
 template <typename Type, typename... Types>
 class Tuple<Type, Types...>
 {
+    static constexpr std::array<size_t, 1 + sizeof...(Types)> ORDER{__tuple_utils::storage_order<Type, Types...>()};
+    static constexpr std::array<size_t, 1 + sizeof...(Types)> SLOTS{__tuple_utils::storage_slots<Type, Types...>()};
+
+    template <size_t Idx>
+    using Leaf = __tuple_utils::Leaf<SLOTS[Idx], type_at_index<Idx, Type, Types...>>;
+
 public:
-    constexpr Tuple(const Type &value, const Types &...remaining) : value{value}, next_tuple{Tuple<Types...>{remaining...}} {}
+    // each element is constructed from its argument, so rvalues are moved in and lvalues are copied
+    template <typename... Args>
+        requires(sizeof...(Args) == 1 + sizeof...(Types)) &&
+                __tuple_utils::each_constructible<__tuple_utils::TypeList<Type, Types...>, __tuple_utils::TypeList<Args...>>
+    constexpr Tuple(Args &&...args)
+        : storage{make_storage(std::forward_as_tuple(std::forward<Args>(args)...), std::index_sequence_for<Type, Types...>{})} {}
 
     template <size_t Idx>
-    constexpr type_at_index<Idx, Type, Types...> get() const
-    {
-        // note: use "if constexpr" to avoid compiling get_tuple_elem<-1, <>> which is an invalid template
-        if constexpr (Idx == 0)
-            return value;
-        else
-            return next_tuple.template get<Idx - 1>();
-    }
+    constexpr type_at_index<Idx, Type, Types...> &get() & { return static_cast<Leaf<Idx> &>(storage).value; }
+
+    template <size_t Idx>
+    constexpr const type_at_index<Idx, Type, Types...> &get() const & { return static_cast<const Leaf<Idx> &>(storage).value; }
+
+    template <size_t Idx>
+    constexpr type_at_index<Idx, Type, Types...> &&get() && { return std::move(static_cast<Leaf<Idx> &>(storage).value); }
 
     friend bool operator==(const Tuple<Type, Types...> &left, const Tuple<Type, Types...> &right)
     {
-        if (left.value != right.value)
-            return false;
-        if constexpr (sizeof...(Types) > 0)
-            return left.next_tuple == right.next_tuple;
-        return true;
+        return [&left, &right]<size_t... Idx>(std::index_sequence<Idx...>)
+        { return ((left.template get<Idx>() == right.template get<Idx>()) && ...); }(std::index_sequence_for<Type, Types...>{});
     }
 
 private:
-    const Type value;
-    const Tuple<Types...> next_tuple;
+    using Storage = __tuple_utils::Storage<std::index_sequence_for<Type, Types...>, Type, Types...>;
+
+    Storage storage;
+
+    template <size_t Slot>
+    using StoredType = type_at_index<ORDER[Slot], Type, Types...>;
+
+    // each slot is initialised from the argument whose element is stored there
+    // the element is constructed explicitly, as brace initialising it would reject narrowing conversions like int to double
+    template <typename Args, size_t... Slots>
+    static constexpr Storage make_storage(Args &&args, std::index_sequence<Slots...>)
+    {
+        return Storage{{StoredType<Slots>(std::get<ORDER[Slots]>(std::move(args)))}...};
+    }
+};
+
+// so tuples can be unpacked with structured bindings, which use the get member
+template <typename... Types>
+struct std::tuple_size<Tuple<Types...>> : std::integral_constant<size_t, sizeof...(Types)>
+{
+};
+
+template <size_t Idx, typename... Types>
+struct std::tuple_element<Idx, Tuple<Types...>>
+{
+    using type = type_at_index<Idx, Types...>;
 };
 
 template <typename... Types>
@@ -109,9 +207,104 @@ void test_tuple()
     assert(tuple3 != (Tuple<int, bool, double>{2, true, 4.3}));
 }
 
+void test_tuple_layout()
+{
+    // stored nested in the order given, these were 24 and 20 bytes
+    static_assert(sizeof(Tuple<char, double, char, int>) == 16);
+    static_assert(sizeof(Tuple<char, int, char, int, char>) == 12);
+    static_assert(sizeof(Tuple<double>) == sizeof(double));
+
+    Tuple<char, double, char, int> tuple{'a', 1.5, 'b', 3};
+    ctest::assert_equal(tuple.get<0>(), 'a');
+    ctest::assert_equal(tuple.get<1>(), 1.5);
+    ctest::assert_equal(tuple.get<2>(), 'b');
+    ctest::assert_equal(tuple.get<3>(), 3);
+    tuple.get<2>() = 'c';
+    ctest::assert_equal(tuple.get<2>(), 'c');
+    ctest::assert_equal(tuple.get<0>(), 'a');
+}
+
+void test_tuple_move()
+{
+    Tuple<std::unique_ptr<int>, std::string> tuple{std::make_unique<int>(5), std::string(100, 'a')};
+    Tuple<std::unique_ptr<int>, std::string> moved{std::move(tuple)};
+    assert(!tuple.get<0>());
+    ctest::assert_equal(*moved.get<0>(), 5);
+
+    Tuple<std::unique_ptr<int>, std::string> assigned{nullptr, ""};
+    assigned = std::move(moved);
+    ctest::assert_equal(*assigned.get<0>(), 5);
+    ctest::assert_equal(assigned.get<1>(), std::string(100, 'a'));
+    std::unique_ptr<int> taken{std::move(assigned).get<0>()};
+    ctest::assert_equal(*taken, 5);
+
+    // lvalues are copied and rvalues moved, in any mix
+    std::unique_ptr<int> pointer{std::make_unique<int>(7)};
+    const std::string text{"kept"};
+    Tuple<std::unique_ptr<int>, std::string> mixed{std::move(pointer), text};
+    assert(!pointer);
+    ctest::assert_equal(*mixed.get<0>(), 7);
+    ctest::assert_equal(text, std::string("kept"));
+    const int count{3};
+    ctest::assert_equal((Tuple<double, long>{count, count}).get<0>(), 3.0);
+    static_assert(!std::constructible_from<Tuple<std::unique_ptr<int>, int>, std::unique_ptr<int> &, int>);
+
+    Tuple<int, std::string> copied{1, "a"};
+    copied = Tuple<int, std::string>{2, "b"};
+    ctest::assert_equal(copied, (Tuple<int, std::string>{2, "b"}));
+}
+
+void test_tuple_structured_bindings()
+{
+    static_assert(std::tuple_size_v<Tuple<int, bool, double>> == 3);
+    static_assert(std::same_as<std::tuple_element_t<1, Tuple<int, bool, double>>, bool>);
+
+    Tuple<char, double, int> tuple{'a', 2.5, 3};
+    const auto [letter, number, count] = tuple;
+    ctest::assert_equal(letter, 'a');
+    ctest::assert_equal(number, 2.5);
+    ctest::assert_equal(count, 3);
+
+    auto &[first, second, third] = tuple;
+    third = 10;
+    ctest::assert_equal(tuple.get<2>(), 10);
+}
+
+// Per item cost of summing a field across an array of tuples, and their size, compared to std::tuple
+void benchmark_tuple_array()
+{
+    const int num_items{1000000};
+    std::vector<Tuple<char, double, char, int>> tuples{};
+    std::vector<std::tuple<char, double, char, int>> std_tuples{};
+    tuples.reserve(num_items);
+    std_tuples.reserve(num_items);
+    for (int i = 0; i < num_items; ++i)
+    {
+        tuples.emplace_back('a', i * 0.5, 'b', i);
+        std_tuples.emplace_back('a', i * 0.5, 'b', i);
+    }
+
+    long total{0};
+    const double seconds{ctest::time_it([&tuples, &total]()
+                                        { for (const Tuple<char, double, char, int> &tuple : tuples)
+                                              total += tuple.get<3>(); })};
+    long std_total{0};
+    const double std_seconds{ctest::time_it([&std_tuples, &std_total]()
+                                            { for (const std::tuple<char, double, char, int> &tuple : std_tuples)
+                                                  std_total += std::get<3>(tuple); })};
+    ctest::assert_equal(total, std_total);
+    std::cout << "ns per item: Tuple " << seconds * 1e9 / num_items << " (" << sizeof(Tuple<char, double, char, int>)
+              << " bytes), std::tuple " << std_seconds * 1e9 / num_items << " (" << sizeof(std::tuple<char, double, char, int>)
+              << " bytes)" << std::endl;
+}
+
 int main()
 {
     test_get_type();
     test_args_size();
     test_tuple();
+    test_tuple_layout();
+    test_tuple_move();
+    test_tuple_structured_bindings();
+    benchmark_tuple_array();
 }
\ No newline at end of file
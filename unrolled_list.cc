@@ -0,0 +1,219 @@
+#include <assert.h>
+#include <vector>
+#include <deque>
+#include <list>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include "unrolled_list.h"
+#include "ctest.h"
+
+void test_unrolled_list_ends()
+{
+    UnrolledList<int> list{};
+    assert(!list);
+    ctest::assert_equal(list.pop(), std::optional<int>{});
+    ctest::assert_equal(list.pop_left(), std::optional<int>{});
+    ctest::assert_equal(list.front(), std::optional<int>{});
+
+    list.add(2);
+    list.add(3);
+    list.add_left(1);
+    list.add_left(0);
+    assert(list);
+    ctest::assert_equal(list.size(), 4);
+    ctest::assert_equal(list.items(), std::vector<int>{0, 1, 2, 3});
+    ctest::assert_equal(list.front(), 0);
+    ctest::assert_equal(list.back(), 3);
+
+    ctest::assert_equal(list.pop(), 3);
+    ctest::assert_equal(list.pop_left(), 0);
+    ctest::assert_equal(list.items(), std::vector<int>{1, 2});
+    ctest::assert_equal(list.pop(), 2);
+    ctest::assert_equal(list.pop(), 1);
+    assert(!list);
+    ctest::assert_equal(list.items(), std::vector<int>{});
+}
+
+void test_unrolled_list_many_chunks()
+{
+    // enough items at both ends to need many chunks
+    const int num_items{10 * static_cast<int>(unrolled_list::CHUNK_CAPACITY<int>)};
+    UnrolledList<int> list{};
+    for (int i = 0; i < num_items; ++i)
+    {
+        list.add(i);
+        list.add_left(-i - 1);
+    }
+    std::vector<int> expected(2 * num_items);
+    std::iota(expected.begin(), expected.end(), -num_items);
+    ctest::assert_equal(list.items(), expected);
+    for (int i = 0; i < 2 * num_items; ++i)
+        ctest::assert_equal(list[i], expected[i]);
+
+    for (int i = 0; i < num_items; ++i)
+    {
+        ctest::assert_equal(list.pop_left(), -num_items + i);
+        ctest::assert_equal(list.pop(), num_items - 1 - i);
+    }
+    assert(!list);
+}
+
+void test_unrolled_list_access()
+{
+    UnrolledList<int> list{1, 2, 3, 4};
+    ctest::assert_equal(list[0], 1);
+    ctest::assert_equal(list[3], 4);
+    list[1] = 20;
+    ctest::assert_equal(list.items(), std::vector<int>{1, 20, 3, 4});
+    ctest::raises<std::range_error>([&list]()
+                                    { list[4]; },
+                                    "Invalid index 4, must be between 0 and 4");
+}
+
+void test_unrolled_list_insert_remove()
+{
+    UnrolledList<int> list{1, 2, 3, 4};
+    list.insert(0, 10);
+    list.insert(2, 5);
+    ctest::assert_equal(list.items(), std::vector<int>{10, 1, 5, 2, 3, 4});
+    // like LinkedList, insert can't add to the end of the list
+    ctest::raises([&list]()
+                  { list.insert(6, 10); });
+
+    list.remove(0);
+    list.remove(4);
+    ctest::assert_equal(list.items(), std::vector<int>{1, 5, 2, 3});
+    ctest::raises([&list]()
+                  { list.remove(4); });
+}
+
+void test_unrolled_list_random()
+{
+    // random operations at the ends and middle, so chunks are split and merged, checked against a deque
+    std::mt19937 generator{42};
+    UnrolledList<int> list{};
+    std::deque<int> expected{};
+    for (int i = 0; i < 100000; ++i)
+    {
+        const int op = generator() % 6;
+        const int index = (expected.empty()) ? 0 : generator() % expected.size();
+        if (op == 0)
+        {
+            list.add(i);
+            expected.push_back(i);
+        }
+        else if (op == 1)
+        {
+            list.add_left(i);
+            expected.push_front(i);
+        }
+        else if (op == 2 && !expected.empty())
+        {
+            list.insert(index, i);
+            expected.insert(expected.begin() + index, i);
+        }
+        else if (op == 3 && !expected.empty())
+        {
+            list.remove(index);
+            expected.erase(expected.begin() + index);
+        }
+        else if (op == 4 && !expected.empty())
+        {
+            ctest::assert_equal(list.pop(), expected.back());
+            expected.pop_back();
+        }
+        else if (op == 5 && !expected.empty())
+        {
+            ctest::assert_equal(list.pop_left(), expected.front());
+            expected.pop_front();
+        }
+        if (!expected.empty())
+            ctest::assert_equal(list[index % expected.size()], expected[index % expected.size()]);
+    }
+    ctest::assert_equal(list.size(), static_cast<int>(expected.size()));
+    ctest::assert_equal(list.items(), std::vector<int>(expected.begin(), expected.end()));
+}
+
+void test_unrolled_list_iterator()
+{
+    static_assert(std::bidirectional_iterator<UnrolledList<int>::Iterator>);
+    UnrolledList<int> list{};
+    for (int i = 0; i < 100; ++i)
+        list.add(i);
+    std::vector<int> forward{};
+    for (const int item : list)
+        forward.push_back(item);
+    ctest::assert_equal(forward, list.items());
+
+    // stepping back from the end visits the items in reverse
+    std::vector<int> backward(list.begin(), list.end());
+    std::vector<int> reversed{};
+    for (auto iter = list.end(); iter != list.begin();)
+        reversed.push_back(*--iter);
+    std::reverse(backward.begin(), backward.end());
+    ctest::assert_equal(reversed, backward);
+
+    for (int &item : list)
+        item *= 2;
+    ctest::assert_equal(list[99], 198);
+
+    const UnrolledList<int> empty{};
+    assert(empty.begin() == empty.end());
+}
+
+void test_unrolled_list_copy()
+{
+    UnrolledList<int> list{1, 2, 3};
+    UnrolledList<int> copy{list};
+    copy.add(4);
+    ctest::assert_equal(list.items(), std::vector<int>{1, 2, 3});
+    ctest::assert_equal(copy.items(), std::vector<int>{1, 2, 3, 4});
+
+    UnrolledList<int> moved{std::move(copy)};
+    ctest::assert_equal(moved.items(), std::vector<int>{1, 2, 3, 4});
+    list = moved;
+    ctest::assert_equal(list.items(), std::vector<int>{1, 2, 3, 4});
+}
+
+void benchmark_unrolled_list()
+{
+    // iteration heavy work, compared against a list with a node per item
+    const int num_items{1000000};
+    const int num_passes{10};
+    UnrolledList<long> unrolled{};
+    std::list<long> linked{};
+    for (long i = 0; i < num_items; ++i)
+    {
+        unrolled.add(i);
+        linked.push_back(i);
+    }
+
+    long unrolled_total{0};
+    const double unrolled_seconds{ctest::time_it([&]()
+                                                 { for (int pass = 0; pass < num_passes; ++pass)
+                                                       for (const long item : unrolled)
+                                                           unrolled_total += item; })};
+    long linked_total{0};
+    const double linked_seconds{ctest::time_it([&]()
+                                               { for (int pass = 0; pass < num_passes; ++pass)
+                                                     for (const long item : linked)
+                                                         linked_total += item; })};
+    ctest::assert_equal(unrolled_total, linked_total);
+    std::cout << "ns per item, unrolled list: " << unrolled_seconds * 1e9 / (num_items * num_passes) << std::endl;
+    std::cout << "ns per item, linked list: " << linked_seconds * 1e9 / (num_items * num_passes) << std::endl;
+}
+
+int main()
+{
+    test_unrolled_list_ends();
+    test_unrolled_list_many_chunks();
+    test_unrolled_list_access();
+    test_unrolled_list_insert_remove();
+    test_unrolled_list_random();
+    test_unrolled_list_iterator();
+    test_unrolled_list_copy();
+    benchmark_unrolled_list();
+}
@@ -0,0 +1,351 @@
+#ifndef CPP_LEARNING_UNROLLED_LIST
+#define CPP_LEARNING_UNROLLED_LIST
+
+#include <array>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+#include <initializer_list>
+#include <cstdint>
+#include <assert.h>
+#include "itertools.h"
+
+namespace unrolled_list
+{
+    // the number of items in a chunk, enough to fill a few cache lines
+    template <typename T>
+    constexpr uint32_t CHUNK_CAPACITY{std::max<uint32_t>(8, 256 / sizeof(T))};
+}
+
+// Linked list that stores a small array of items in each node, so iterating reads whole cache lines of items at a time
+// Each chunk's items are kept in a contiguous range of its array that can start anywhere,
+// so items can be added at either end of the list without shifting anything
+template <typename T>
+class UnrolledList
+{
+    static constexpr uint32_t CAPACITY{unrolled_list::CHUNK_CAPACITY<T>};
+
+    struct Chunk
+    {
+        std::array<T, CAPACITY> items;
+        uint32_t begin{0}; // items[begin:end] are in use
+        uint32_t end{0};
+        Chunk *next_chunk{nullptr};
+        Chunk *prev_chunk{nullptr};
+
+        uint32_t size() const { return end - begin; }
+    };
+
+public:
+    using value_type = T;
+
+    struct Iterator
+    {
+    public:
+        typedef T value_type;
+        typedef T &reference;
+        typedef T *pointer;
+        typedef std::ptrdiff_t difference_type;
+        typedef std::bidirectional_iterator_tag iterator_category;
+
+        Iterator() : list{nullptr}, chunk{nullptr}, position{0} {}
+
+        Iterator(const UnrolledList *list, Chunk *chunk, const uint32_t position) : list{list}, chunk{chunk}, position{position} {}
+
+        reference operator*() const { return chunk->items[position]; }
+        pointer operator->() const { return &chunk->items[position]; }
+        Iterator &operator++()
+        {
+            if (++position == chunk->end)
+            {
+                chunk = chunk->next_chunk;
+                position = (chunk) ? chunk->begin : 0;
+            }
+            return *this;
+        }
+        Iterator operator++(int)
+        {
+            Iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+        Iterator &operator--()
+        {
+            if (!chunk || position == chunk->begin)
+            {
+                chunk = (chunk) ? chunk->prev_chunk : list->last;
+                position = chunk->end;
+            }
+            --position;
+            return *this;
+        }
+        Iterator operator--(int)
+        {
+            Iterator temp = *this;
+            --*this;
+            return temp;
+        }
+        friend bool operator==(const Iterator &iter1, const Iterator &iter2) { return iter1.chunk == iter2.chunk && iter1.position == iter2.position; }
+        friend bool operator!=(const Iterator &iter1, const Iterator &iter2) { return !(iter1 == iter2); }
+
+    private:
+        const UnrolledList *list; // to step back from the end
+        Chunk *chunk;             // nullptr at the end
+        uint32_t position;
+    };
+
+    using iterator = Iterator;
+    using const_iterator = Iterator;
+
+    UnrolledList() : first{nullptr}, last{nullptr}, length{0} {}
+
+    UnrolledList(const std::initializer_list<T> &items) : UnrolledList()
+    {
+        for (const T &item : items)
+            add(item);
+    }
+
+    UnrolledList(const UnrolledList &other) : UnrolledList()
+    {
+        for (const T &item : other)
+            add(item);
+    }
+
+    UnrolledList(UnrolledList &&other) : UnrolledList() { other.swap(*this); }
+
+    UnrolledList &operator=(const UnrolledList &other)
+    {
+        UnrolledList(other).swap(*this);
+        return *this;
+    }
+
+    UnrolledList &operator=(UnrolledList &&other)
+    {
+        UnrolledList(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~UnrolledList()
+    {
+        while (first)
+        {
+            Chunk *next{first->next_chunk};
+            delete first;
+            first = next;
+        }
+    }
+
+    // add item to the end of the list, O(1)
+    void add(const T &item)
+    {
+        if (!last || last->end == CAPACITY)
+            link_after(last, new Chunk{});
+        last->items[last->end++] = item;
+        ++length;
+    }
+
+    // add item to the start of the list, O(1)
+    void add_left(const T &item)
+    {
+        if (!first || first->begin == 0)
+        {
+            // fill the new chunk from the back, so the following add_lefts go in front of this item
+            link_before(first, new Chunk{});
+            first->begin = first->end = CAPACITY;
+        }
+        first->items[--first->begin] = item;
+        ++length;
+    }
+
+    // remove and return the last item in the list. If the list is empty returns nullopt
+    std::optional<T> pop()
+    {
+        if (length == 0)
+            return std::nullopt;
+        T item{std::move(last->items[--last->end])};
+        --length;
+        if (last->size() == 0)
+            unlink(last);
+        return item;
+    }
+
+    std::optional<T> pop_left()
+    {
+        if (length == 0)
+            return std::nullopt;
+        T item{std::move(first->items[first->begin++])};
+        --length;
+        if (first->size() == 0)
+            unlink(first);
+        return item;
+    }
+
+    // insert item so that it becomes the item at index, moving the following items up
+    // O(n / chunk size) to find the chunk, and O(chunk size) to make room in it
+    void insert(const int index, const T &item)
+    {
+        itertools::validate_index(index, length);
+        auto [chunk, position]{find(index)};
+        if (chunk->size() == CAPACITY)
+        {
+            // move the second half of the full chunk into a new chunk after it
+            Chunk *const new_chunk{new Chunk{}};
+            const uint32_t half{chunk->begin + CAPACITY / 2};
+            std::move(chunk->items.begin() + half, chunk->items.begin() + chunk->end, new_chunk->items.begin());
+            new_chunk->end = chunk->end - half;
+            chunk->end = half;
+            link_after(chunk, new_chunk);
+            if (position >= half)
+            {
+                chunk = new_chunk;
+                position -= half;
+            }
+        }
+
+        // shift whichever side of the chunk has space
+        if (chunk->end < CAPACITY)
+        {
+            std::move_backward(chunk->items.begin() + position, chunk->items.begin() + chunk->end, chunk->items.begin() + chunk->end + 1);
+            ++chunk->end;
+        }
+        else
+        {
+            std::move(chunk->items.begin() + chunk->begin, chunk->items.begin() + position, chunk->items.begin() + chunk->begin - 1);
+            --chunk->begin;
+            --position;
+        }
+        chunk->items[position] = item;
+        ++length;
+    }
+
+    // remove the item at index, merging its chunk with the next one if together they only fill half a chunk
+    void remove(const int index)
+    {
+        itertools::validate_index(index, length);
+        auto [chunk, position]{find(index)};
+        std::move(chunk->items.begin() + position + 1, chunk->items.begin() + chunk->end, chunk->items.begin() + position);
+        --chunk->end;
+        --length;
+        if (chunk->size() == 0)
+            unlink(chunk);
+        else if (chunk->next_chunk && chunk->size() + chunk->next_chunk->size() <= CAPACITY / 2)
+            merge_next(chunk);
+    }
+
+    std::optional<T> front() const
+    {
+        return (length > 0) ? std::make_optional<T>(first->items[first->begin]) : std::nullopt;
+    }
+
+    std::optional<T> back() const
+    {
+        return (length > 0) ? std::make_optional<T>(last->items[last->end - 1]) : std::nullopt;
+    }
+
+    // get item, O(n / chunk size) as only the chunks are walked, from whichever end is closer
+    T &operator[](const int index)
+    {
+        itertools::validate_index(index, length);
+        const auto [chunk, position]{find(index)};
+        return chunk->items[position];
+    }
+
+    std::vector<T> items() const
+    {
+        std::vector<T> result{};
+        result.reserve(length);
+        for (const Chunk *chunk = first; chunk; chunk = chunk->next_chunk)
+            result.insert(result.end(), chunk->items.begin() + chunk->begin, chunk->items.begin() + chunk->end);
+        return result;
+    }
+
+    Iterator begin() const { return Iterator(this, first, (first) ? first->begin : 0); }
+
+    Iterator end() const { return Iterator(this, nullptr, 0); }
+
+    int size() const { return length; }
+
+    explicit operator bool() const { return length > 0; }
+
+    void swap(UnrolledList &other) noexcept
+    {
+        std::swap(this->first, other.first);
+        std::swap(this->last, other.last);
+        std::swap(this->length, other.length);
+    }
+
+private:
+    Chunk *first;
+    Chunk *last;
+    int length;
+
+    // the chunk holding the item at index, and the item's position in that chunk
+    std::tuple<Chunk *, uint32_t> find(int index) const
+    {
+        assert(index >= 0 && index < length);
+        if (index < length / 2)
+        {
+            Chunk *chunk{first};
+            while (index >= static_cast<int>(chunk->size()))
+            {
+                index -= chunk->size();
+                chunk = chunk->next_chunk;
+            }
+            return {chunk, chunk->begin + index};
+        }
+        int from_end{length - 1 - index};
+        Chunk *chunk{last};
+        while (from_end >= static_cast<int>(chunk->size()))
+        {
+            from_end -= chunk->size();
+            chunk = chunk->prev_chunk;
+        }
+        return {chunk, chunk->end - 1 - from_end};
+    }
+
+    // link new_chunk in after chunk, or as the first chunk if chunk is nullptr
+    void link_after(Chunk *chunk, Chunk *new_chunk)
+    {
+        new_chunk->prev_chunk = chunk;
+        new_chunk->next_chunk = (chunk) ? chunk->next_chunk : first;
+        if (new_chunk->next_chunk)
+            new_chunk->next_chunk->prev_chunk = new_chunk;
+        else
+            last = new_chunk;
+        if (chunk)
+            chunk->next_chunk = new_chunk;
+        else
+            first = new_chunk;
+    }
+
+    void link_before(Chunk *chunk, Chunk *new_chunk)
+    {
+        link_after((chunk) ? chunk->prev_chunk : last, new_chunk);
+    }
+
+    void unlink(Chunk *chunk)
+    {
+        ((chunk->prev_chunk) ? chunk->prev_chunk->next_chunk : first) = chunk->next_chunk;
+        ((chunk->next_chunk) ? chunk->next_chunk->prev_chunk : last) = chunk->prev_chunk;
+        delete chunk;
+    }
+
+    // move the next chunk's items onto the end of chunk, then remove the next chunk
+    void merge_next(Chunk *chunk)
+    {
+        Chunk *const next{chunk->next_chunk};
+        if (chunk->end + next->size() > CAPACITY)
+        {
+            std::move(chunk->items.begin() + chunk->begin, chunk->items.begin() + chunk->end, chunk->items.begin());
+            chunk->end -= chunk->begin;
+            chunk->begin = 0;
+        }
+        std::move(next->items.begin() + next->begin, next->items.begin() + next->end, chunk->items.begin() + chunk->end);
+        chunk->end += next->size();
+        unlink(next);
+    }
+};
+
+#endif